@@ -0,0 +1,256 @@
+/**
+ * @file TaskScheduler.h
+ * @brief Work-stealing thread pool shared by the simulation, routing and
+ * generators: parallel loops, task groups and per-worker scratch.
+ */
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scheduler_detail {
+
+// Shared state of one parallelFor(). Helpers that start after the caller has
+// closed the loop return without touching the loop body.
+struct Loop {
+  explicit Loop(std::size_t n) : count(n) {}
+
+  template <class Fn> void work(std::size_t worker, Fn &fn) {
+    try {
+      for (std::size_t i = next++; i < count; i = next++)
+        fn(worker, i);
+    } catch (...) {
+      std::lock_guard lock(mutex);
+      if (!error)
+        error = std::current_exception();
+      next = count;
+    }
+  }
+
+  bool enter() {
+    std::lock_guard lock(mutex);
+    if (closed)
+      return false;
+    ++active;
+    return true;
+  }
+
+  void leave() {
+    std::lock_guard lock(mutex);
+    if (--active == 0)
+      done.notify_all();
+  }
+
+  // Stop new helpers, wait for running ones, rethrow the first error.
+  void close() {
+    std::unique_lock lock(mutex);
+    closed = true;
+    done.wait(lock, [this] { return active == 0; });
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  std::atomic<std::size_t> next{0};
+  const std::size_t count;
+  std::mutex mutex;
+  std::condition_variable done;
+  std::size_t active{0};
+  bool closed{false};
+  std::exception_ptr error;
+};
+
+} // namespace scheduler_detail
+
+/**
+ * @class TaskScheduler
+ * @brief Fixed pool of worker threads with one task deque per worker.
+ *
+ * @details
+ * A worker pops its own deque from the back (newest first, still warm in its
+ * cache) and, when that is empty, takes from the shared queue of tasks
+ * submitted by other threads and then steals from the front of the other
+ * workers' deques. Idle workers sleep until a task arrives.
+ *
+ * Every thread that runs work has a worker index: pool threads are numbered
+ * 1 ... workerSlots() - 1 and any other thread is 0. Index it into
+ * PerWorker scratch; at most one thread outside the pool may use the
+ * scheduler's parallel loops at a time.
+ *
+ * One scheduler is meant to serve the whole process (Simulation owns it and
+ * hands it to its subsystems), so cores are shared instead of each subsystem
+ * starting its own threads.
+ */
+class TaskScheduler {
+public:
+  using Task = std::function<void()>;
+
+  /**
+   * @param threads    Threads working on a parallelFor(), the caller
+   *                   included; 0 uses std::thread::hardware_concurrency().
+   *                   threads - 1 workers are started, but at least one, so
+   *                   submit() never runs on the caller.
+   * @param pinThreads Pin worker i to CPU i (Linux only; ignored elsewhere).
+   */
+  explicit TaskScheduler(unsigned threads = 0, bool pinThreads = false);
+
+  /// @brief Runs the tasks still queued, then joins the workers.
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  /// @return Threads a parallelFor() spreads over (at least 1).
+  [[nodiscard]] unsigned threads() const noexcept { return threads_; }
+
+  /// @return Number of distinct worker indices (pool threads + 1).
+  [[nodiscard]] std::size_t workerSlots() const noexcept {
+    return workers_.size() + 1;
+  }
+
+  /// @return Worker index of the calling thread (0 outside the pool).
+  [[nodiscard]] std::size_t currentWorker() const noexcept;
+
+  /**
+   * @brief Queue @p task to run on some worker. Fire-and-forget: use a
+   * TaskGroup to wait for tasks or to collect their exceptions; an exception
+   * escaping a bare task terminates the program.
+   */
+  void submit(Task task);
+
+  /**
+   * @brief Run one queued task on the calling thread.
+   * @return false if no task was queued.
+   */
+  bool runPending();
+
+  /**
+   * @brief Run fn(worker, i) for every i in [0, count) and wait for all.
+   *
+   * Items are handed out one at a time, so uneven items balance; callers
+   * with many cheap items should group them into chunks. The calling thread
+   * works on the loop itself; up to threads() - 1 workers join it as they
+   * become free, so a busy pool slows the loop down but never blocks it.
+   * The first exception thrown by @p fn is rethrown once every helper has
+   * left the loop.
+   */
+  template <class Fn> void parallelFor(std::size_t count, Fn &&fn) {
+    const std::size_t self = currentWorker();
+    const std::size_t helpers =
+        std::min<std::size_t>(threads_ - 1, count > 0 ? count - 1 : 0);
+    if (helpers == 0) {
+      for (std::size_t i = 0; i < count; ++i)
+        fn(self, i);
+      return;
+    }
+    auto loop = std::make_shared<scheduler_detail::Loop>(count);
+    auto *body = &fn;
+    for (std::size_t h = 0; h < helpers; ++h) {
+      submit([this, loop, body] {
+        if (!loop->enter())
+          return;
+        loop->work(currentWorker(), *body);
+        loop->leave();
+      });
+    }
+    loop->work(self, fn);
+    loop->close();
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void workerLoop(std::size_t worker);
+
+  // Pop a task for @p worker: own deque, then the shared queue, then steal.
+  bool take(std::size_t worker, Task &task);
+
+  unsigned threads_{1};
+  std::vector<std::unique_ptr<Queue>> queues_; ///< By worker; [0] shared.
+
+  std::mutex sleepMutex_;
+  std::condition_variable wake_;
+  std::size_t queued_{0}; ///< Tasks in any queue (under sleepMutex_).
+  bool stopping_{false};
+
+  std::vector<std::thread> workers_;
+};
+
+/**
+ * @class TaskGroup
+ * @brief Tasks that are waited for together.
+ *
+ * wait() helps: while tasks of the group are outstanding, the waiting
+ * thread runs queued tasks (of any group) instead of sleeping.
+ */
+class TaskGroup {
+public:
+  explicit TaskGroup(TaskScheduler &scheduler) : scheduler_(scheduler) {}
+
+  /// @brief Waits for outstanding tasks; their exceptions are dropped.
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  /// @brief Queue @p task as part of the group (safe from any thread).
+  void run(TaskScheduler::Task task);
+
+  /// @brief Wait for every task run() so far; rethrows the first exception.
+  void wait();
+
+private:
+  TaskScheduler &scheduler_;
+  std::mutex mutex_;
+  std::condition_variable done_;
+  std::size_t pending_{0};
+  std::exception_ptr error_;
+};
+
+/**
+ * @class PerWorker
+ * @brief One T per worker index, each on its own cache lines.
+ *
+ * Scratch arena for parallel loops: slot w is only touched by the thread
+ * with worker index w, and keeps its allocations from one loop to the next.
+ */
+template <class T> class PerWorker {
+public:
+  PerWorker() = default;
+  explicit PerWorker(std::size_t slots) : slots_(slots) {}
+
+  /// @brief Make room for every worker of @p scheduler (null: one slot).
+  void fit(const TaskScheduler *scheduler) {
+    const std::size_t n = scheduler ? scheduler->workerSlots() : 1;
+    if (slots_.size() < n)
+      slots_.resize(n);
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return slots_.size(); }
+  [[nodiscard]] T &operator[](std::size_t worker) {
+    return slots_[worker].value;
+  }
+  [[nodiscard]] const T &operator[](std::size_t worker) const {
+    return slots_[worker].value;
+  }
+
+private:
+  struct alignas(64) Slot {
+    T value{};
+  };
+  std::vector<Slot> slots_;
+};
+
+#endif // TASK_SCHEDULER_H
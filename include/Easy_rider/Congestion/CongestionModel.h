@@ -96,6 +96,28 @@ public:
    */
   [[nodiscard]] double effectiveSpeed(const Road &road) const;
 
+  /**
+   * @brief Free-flow speed of the road (max speed, capped by any override).
+   */
+  [[nodiscard]] double freeSpeed(const Road &road) const;
+
+  /**
+   * @brief Halving rule for an arbitrary load (e.g. a forecast).
+   * @param vFree    Free-flow speed (see freeSpeed()).
+   * @param capacity Tier size x (see capacityFor()).
+   * @param load     Number of vehicles on the edge.
+   */
+  [[nodiscard]] static double speedForLoad(double vFree, int capacity,
+                                           int load) {
+    if (load <= 0)
+      return vFree;
+    const int x = std::max(1, capacity);
+    // Tier index m = ceil(N/x). Divisor = 2^(m-1).
+    const int m = (load + x - 1) / x;        // ceil division, m >= 1
+    const int exponent = std::max(0, m - 1); // 0 in first tier
+    return std::max(1e-6, vFree * std::ldexp(1.0, -exponent));
+  }
+
   /**
    * @brief Get travel time over road for a vehicle with its own max speed cap.
    * @param road               Road edge.
@@ -104,11 +126,25 @@ public:
    */
   [[nodiscard]] double edgeTime(const Road &road, int vehicleMaxSpeed) const;
 
-private:
+  /**
+   * @brief Travel time for a known effective speed (shared by edgeTime() and
+   * per-tick snapshots such as EdgeTimeTable).
+   * @param length           Edge length.
+   * @param effectiveSpeed   Congestion-aware edge speed.
+   * @param vehicleMaxSpeed  Vehicle's own max speed (cap).
+   */
+  [[nodiscard]] static double travelTime(double length, double effectiveSpeed,
+                                         int vehicleMaxSpeed) {
+    const double len = std::max(1e-9, length);
+    const double v_vehicle = static_cast<double>(std::max(1, vehicleMaxSpeed));
+    return len / std::min(v_vehicle, effectiveSpeed);
+  }
+
   /// @brief Resolve capacity x for a given road (falls back to default if <=
   /// 0).
   [[nodiscard]] int capacityFor(const Road &road) const;
 
+private:
   // Live per-edge state (counts and temporary limits).
   std::unordered_map<EdgeKey, EdgeState, EdgeKeyHash> state_;
 
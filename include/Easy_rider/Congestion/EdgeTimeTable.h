@@ -0,0 +1,155 @@
+/**
+ * @file EdgeTimeTable.h
+ * @brief Dense per-tick snapshot of effective speed and travel time per edge.
+ *
+ * The table is indexed by edge index (position in Graph::getEdges()) and is
+ * rebuilt once per simulation tick from the CongestionModel. Every consumer
+ * (vehicle kinematics, ETA estimation, routing strategies) reads the same
+ * snapshot, so all queries within one tick see a consistent weight set and a
+ * weight lookup is a single array load.
+ */
+#ifndef EDGE_TIME_TABLE_H
+#define EDGE_TIME_TABLE_H
+
+#include "Easy_rider/Congestion/CongestionModel.h"
+#include "Easy_rider/TrafficInfrastructure/Graph.h"
+#include "Easy_rider/TrafficInfrastructure/Intersection.h"
+#include "Easy_rider/TrafficInfrastructure/Road.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * @class EdgeTimeTable
+ * @brief Per-edge effective speed and per-vehicle-class travel time arrays.
+ *
+ * Layout:
+ *  - speed_[e]                 = CongestionModel::effectiveSpeed(edge e).
+ *  - times_[c * E + e]         = CongestionModel::edgeTime(edge e, cap[c]).
+ *  - vmax_[c]                  = max over edges of length / times(c, e),
+ *                                an admissible speed bound for A*.
+ *  - freeSpeed_[e], capacity_[e] = inputs of the halving rule, so forecast
+ *                                loads can be turned into speeds off-thread.
+ */
+class EdgeTimeTable {
+public:
+  /**
+   * @param classSpeedCaps Max speed of each vehicle class, indexed by class.
+   */
+  explicit EdgeTimeTable(std::vector<int> classSpeedCaps = {});
+
+  /**
+   * @brief Recompute all arrays from the current congestion state.
+   *
+   * Resizes the arrays if the edge count changed. epoch() is advanced only if
+   * at least one value differs from the previous snapshot.
+   */
+  void rebuild(const Graph<Intersection, Road> &graph,
+               const CongestionModel &congestion);
+
+  /// @return Number of edges covered by the snapshot.
+  [[nodiscard]] std::size_t edgeCount() const noexcept {
+    return lengths_.size();
+  }
+
+  /// @return Number of registered vehicle classes.
+  [[nodiscard]] std::size_t classCount() const noexcept {
+    return classSpeedCaps_.size();
+  }
+
+  /// @return Effective (congestion-aware) speed on edge @p edgeIdx.
+  [[nodiscard]] double effectiveSpeed(std::size_t edgeIdx) const {
+    return speed_[edgeIdx];
+  }
+
+  /// @return Free-flow speed (max speed, capped by overrides) of an edge.
+  [[nodiscard]] double freeSpeed(std::size_t edgeIdx) const {
+    return freeSpeed_[edgeIdx];
+  }
+
+  /// @return Congestion tier size (vehicles) of an edge.
+  [[nodiscard]] int capacity(std::size_t edgeIdx) const {
+    return capacity_[edgeIdx];
+  }
+
+  /// @return Highest free-flow speed over all edges.
+  [[nodiscard]] double maxFreeSpeed() const noexcept { return maxFreeSpeed_; }
+
+  /// @return Max speed of vehicle class @p classIdx.
+  [[nodiscard]] int classSpeedCap(std::size_t classIdx) const {
+    return classSpeedCaps_[classIdx];
+  }
+
+  /// @return Length of edge @p edgeIdx.
+  [[nodiscard]] double length(std::size_t edgeIdx) const {
+    return lengths_[edgeIdx];
+  }
+
+  /// @return Travel time over edge @p edgeIdx for vehicle class @p classIdx.
+  [[nodiscard]] double travelTime(std::size_t classIdx,
+                                  std::size_t edgeIdx) const {
+    return times_[classIdx * edgeCount() + edgeIdx];
+  }
+
+  /// @return All travel times of one class, indexed by edge index.
+  [[nodiscard]] std::span<const double>
+  travelTimes(std::size_t classIdx) const {
+    return {times_.data() + classIdx * edgeCount(), edgeCount()};
+  }
+
+  /// @return Travel times of one class on empty roads, indexed by edge index.
+  [[nodiscard]] std::vector<double> freeFlowTimes(std::size_t classIdx) const;
+
+  /// @return Upper bound on length / travelTime over all edges of a class.
+  [[nodiscard]] double vmaxUpperBound(std::size_t classIdx) const {
+    return vmax_[classIdx];
+  }
+
+  /// @return Counter advanced whenever a rebuild changed any edge value.
+  [[nodiscard]] std::uint64_t epoch() const noexcept { return epoch_; }
+
+  /**
+   * @brief Edges whose length or effective speed changed between epoch() - 1
+   * and epoch().
+   *
+   * Lets incremental consumers that are one epoch behind repair their state
+   * instead of rescanning every edge. Consumers further behind must diff the
+   * full arrays.
+   */
+  [[nodiscard]] std::span<const std::size_t> changedEdges() const noexcept {
+    return changed_;
+  }
+
+  /**
+   * @brief Edges changed after epoch @p since, oldest epoch first.
+   *
+   * An edge appears once per epoch it changed in. Only recent epochs are
+   * kept (about 2 * edgeCount() entries); diffing the arrays is cheaper than
+   * replaying more than that.
+   * @return The change list, or std::nullopt if @p since is older than the
+   * kept history.
+   */
+  [[nodiscard]] std::optional<std::span<const std::size_t>>
+  changesSince(std::uint64_t since) const;
+
+private:
+  std::vector<int> classSpeedCaps_;  ///< Max speed per vehicle class.
+  std::vector<double> lengths_;      ///< Edge lengths.
+  std::vector<double> speed_;        ///< Effective speed per edge.
+  std::vector<double> freeSpeed_;    ///< Free-flow speed per edge.
+  std::vector<int> capacity_;        ///< Tier size per edge.
+  double maxFreeSpeed_{0.0};         ///< Max of freeSpeed_.
+  std::vector<double> times_;        ///< Class-major travel times.
+  std::vector<double> vmax_;         ///< A* speed bound per class.
+  std::vector<std::size_t> changed_; ///< Edges changed by the last epoch.
+  std::vector<std::size_t> scratch_; ///< Change list being collected.
+  std::uint64_t epoch_{0};           ///< Change counter.
+  std::vector<std::size_t> history_; ///< changed_ of the kept epochs.
+  std::vector<std::size_t> historyStart_{}; ///< Offset of each kept epoch.
+  std::uint64_t historyBase_{0}; ///< Changes after this epoch are kept.
+};
+
+#endif // EDGE_TIME_TABLE_H
@@ -0,0 +1,179 @@
+/**
+ * @file LoadForecast.h
+ * @brief Time-bucketed per-edge load forecast built from in-flight routes.
+ *
+ * Every vehicle with a route contributes +1 to each edge it is expected to
+ * occupy, for each time bucket between its predicted entry and exit. Routers
+ * can then evaluate an edge at the time a vehicle would actually reach it,
+ * instead of at the instantaneous load.
+ */
+#ifndef LOAD_FORECAST_H
+#define LOAD_FORECAST_H
+
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "Easy_rider/TrafficInfrastructure/Graph.h"
+#include "Easy_rider/TrafficInfrastructure/Intersection.h"
+#include "Easy_rider/TrafficInfrastructure/Road.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ForecastTable
+ * @brief Expected vehicle count per edge and future time bucket.
+ *
+ * A ring of horizonBuckets() buckets of bucketSeconds() each, starting at the
+ * bucket that contains now(). Buckets that fall behind now() are cleared by
+ * advanceTo(). The table is a plain value, so a copy can be handed to worker
+ * threads as an immutable snapshot.
+ */
+class ForecastTable {
+public:
+  /**
+   * @param bucketSeconds  Width of one time bucket (seconds, > 0).
+   * @param horizonBuckets Number of buckets kept ahead of now (>= 1).
+   */
+  explicit ForecastTable(double bucketSeconds = 5.0,
+                         std::size_t horizonBuckets = 24);
+
+  /// @brief Size for @p edgeCount edges; clears all counts.
+  void resize(std::size_t edgeCount);
+
+  /// @brief Move the window to start at @p now, clearing expired buckets.
+  void advanceTo(double now);
+
+  /// @return Absolute bucket number containing time @p t.
+  [[nodiscard]] std::int64_t bucketOf(double t) const {
+    return static_cast<std::int64_t>(std::floor(t / bucketSeconds_));
+  }
+
+  /// @return Last bucket inside the horizon.
+  [[nodiscard]] std::int64_t lastBucket() const noexcept {
+    return base_ + static_cast<std::int64_t>(horizon_) - 1;
+  }
+
+  /**
+   * @brief Add @p delta to edge @p edgeIdx over buckets [first, last].
+   *
+   * The range is clipped to the current window.
+   * @return The clipped range actually updated (first > last if empty).
+   */
+  std::pair<std::int64_t, std::int64_t>
+  add(std::size_t edgeIdx, std::int64_t first, std::int64_t last, int delta);
+
+  /**
+   * @return Expected vehicles on edge @p edgeIdx at time @p t, or
+   * std::nullopt if @p t lies beyond the horizon. Times before now() read
+   * the current bucket.
+   */
+  [[nodiscard]] std::optional<int> load(std::size_t edgeIdx, double t) const {
+    const std::int64_t b = std::max(base_, bucketOf(t));
+    if (b > lastBucket() || edgeIdx >= edges_)
+      return std::nullopt;
+    return counts_[edgeIdx * horizon_ + slot(b)];
+  }
+
+  [[nodiscard]] double now() const noexcept { return now_; }
+  [[nodiscard]] double bucketSeconds() const noexcept {
+    return bucketSeconds_;
+  }
+  [[nodiscard]] std::size_t horizonBuckets() const noexcept {
+    return horizon_;
+  }
+  [[nodiscard]] std::size_t edgeCount() const noexcept { return edges_; }
+
+private:
+  [[nodiscard]] std::size_t slot(std::int64_t bucket) const {
+    const auto h = static_cast<std::int64_t>(horizon_);
+    return static_cast<std::size_t>(((bucket % h) + h) % h);
+  }
+
+  double bucketSeconds_;
+  std::size_t horizon_;
+  double now_{0.0};
+  std::int64_t base_{0};    ///< Bucket containing now_.
+  std::size_t edges_{0};    ///< Edge count.
+  std::vector<int> counts_; ///< Edge-major: counts_[e * horizon_ + slot].
+};
+
+/**
+ * @class LoadForecast
+ * @brief Maintains a ForecastTable from the planned routes of all vehicles.
+ *
+ * @details
+ * replan() predicts entry/exit times along a vehicle's remaining route from
+ * the current edge time snapshot and records its contributions. Later events
+ * cost O(buckets of one edge): onEnterEdge() retires the contribution of the
+ * edge just left, and forget() removes a vehicle. A vehicle that drifts more
+ * than one bucket from its prediction, or runs past the end of what was
+ * predicted, is re-predicted from its current edge. Contributions beyond the
+ * horizon are not recorded.
+ *
+ * Not thread-safe; share table() copies with other threads.
+ */
+class LoadForecast {
+public:
+  /**
+   * @param graph          Road network (must outlive the forecast).
+   * @param edgeTimes      Snapshot used for predicted traversal times (must
+   *                       outlive the forecast).
+   * @param bucketSeconds  Width of one time bucket.
+   * @param horizonBuckets Number of buckets ahead of now.
+   */
+  LoadForecast(const Graph<Intersection, Road> &graph,
+               const EdgeTimeTable &edgeTimes, double bucketSeconds,
+               std::size_t horizonBuckets);
+
+  /// @brief Advance the window to @p now (call once per tick).
+  void advanceTo(double now);
+
+  /**
+   * @brief Replace the contributions of one vehicle.
+   * @param vehicleId  Vehicle id.
+   * @param classIdx   Vehicle class (selects travel times).
+   * @param route      Full route as node ids.
+   * @param routeIndex Index of the current edge's start node in @p route.
+   * @param sOnEdge    Progress along the current edge.
+   */
+  void replan(int vehicleId, std::size_t classIdx,
+              const std::vector<int> &route, std::size_t routeIndex,
+              double sOnEdge);
+
+  /// @brief The vehicle entered edge @p edgeIdx of its planned route.
+  void onEnterEdge(int vehicleId, std::size_t edgeIdx);
+
+  /// @brief Remove all contributions of a vehicle (arrival, removal).
+  void forget(int vehicleId);
+
+  /// @return Current forecast.
+  [[nodiscard]] const ForecastTable &table() const noexcept { return table_; }
+
+private:
+  struct Plan {
+    std::size_t classIdx{0};
+    std::vector<std::size_t> edges; ///< Remaining route as edge indices.
+    /// Recorded bucket range per predicted edge; parallel to a prefix of
+    /// edges (the part inside the horizon at prediction time).
+    std::vector<std::pair<std::int64_t, std::int64_t>> spans;
+    std::size_t next{0}; ///< First edge whose contribution is still live.
+  };
+
+  // Predict edges [from, ...) starting at time t; the first edge is only
+  // firstFraction long.
+  void predict(Plan &plan, std::size_t from, double t, double firstFraction);
+
+  // Retire the recorded contributions of edges [from, to).
+  void retire(Plan &plan, std::size_t from, std::size_t to);
+
+  const Graph<Intersection, Road> &graph_;
+  const EdgeTimeTable &edgeTimes_;
+  ForecastTable table_;
+  std::unordered_map<int, Plan> plans_; ///< vehicleId -> plan.
+};
+
+#endif // LOAD_FORECAST_H
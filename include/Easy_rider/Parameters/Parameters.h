@@ -1,6 +1,5 @@
 #ifndef PARAMETERS_H
 #define PARAMETERS_H
-#include <SFML/Graphics/Color.hpp>
 #include <cstdint>
 #include <string>
 
@@ -12,9 +11,17 @@ public:
 
   float &VehicleRadius() const;
 
+  // Time warp: simulated seconds per real second (more steps, not longer).
   static void set_simulationSpeed(float s) { simulationSpeed_ = s; }
   static float simulationSpeed() { return simulationSpeed_; }
 
+  // Fixed step of Simulation::advanceFrame(), in simulated seconds.
+  static void set_physicsDt(double v) { physicsDt_ = v; }
+  static double physicsDt() { return physicsDt_; }
+  // Steps per frame before the rest of a long frame is dropped.
+  static void set_maxSubsteps(unsigned v) { maxSubsteps_ = v; }
+  static unsigned maxSubsteps() { return maxSubsteps_; }
+
   static void set_fontPath(const std::string &path) { fontPath_ = path; }
   static const std::string &fontPath() { return fontPath_; }
 
@@ -96,11 +103,6 @@ public:
   static void set_vechicleColor(uint32_t v) { vechicleColor_ = v; }
   static uint32_t vechicleColor() { return vechicleColor_; }
 
-  static sf::Color argb(uint32_t c) {
-    return sf::Color((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF,
-                     (c >> 24) & 0xFF);
-  }
-
   static void set_targetNodes(int v) { targetNodes_ = v; }
   static int targetNodes() { return targetNodes_; }
   static void set_minDistPx(int v) { minDistPx_ = v; }
@@ -150,9 +152,100 @@ public:
 
   static void set_isDijkstra(bool v) { isDijkstra_ = v; }
   static bool isDijkstra() { return isDijkstra_; }
+  // Incremental (D* Lite style) rerouting; takes precedence over isDijkstra.
+  static void set_incrementalRouting(bool v) { incrementalRouting_ = v; }
+  static bool incrementalRouting() { return incrementalRouting_; }
+  // Pick A*, bidirectional, cached tree or hierarchy per query from measured
+  // latency; takes precedence over isDijkstra.
+  static void set_adaptiveRouting(bool v) { adaptiveRouting_ = v; }
+  static bool adaptiveRouting() { return adaptiveRouting_; }
+  static void set_destinationTreeCache(bool v) { destinationTreeCache_ = v; }
+  static bool destinationTreeCache() { return destinationTreeCache_; }
+  static void set_destinationCacheSize(unsigned v) {
+    destinationCacheSize_ = v;
+  }
+  static unsigned destinationCacheSize() { return destinationCacheSize_; }
+  static void set_destinationCacheMinDemand(unsigned v) {
+    destinationCacheMinDemand_ = v;
+  }
+  static unsigned destinationCacheMinDemand() {
+    return destinationCacheMinDemand_;
+  }
+  // Weighted A* (f = g + w * h): routes cost at most w times the optimum.
+  static void set_astarWeight(double v) { astarWeight_ = v; }
+  static double astarWeight() { return astarWeight_; }
+  static void set_astarWeightMax(double v) { astarWeightMax_ = v; }
+  static double astarWeightMax() { return astarWeightMax_; }
+  // Compare every n-th A* route with Dijkstra (0 = never).
+  static void set_routeQualitySampleEvery(unsigned v) {
+    routeQualitySampleEvery_ = v;
+  }
+  static unsigned routeQualitySampleEvery() {
+    return routeQualitySampleEvery_;
+  }
+  // Dense all-pairs tables replace A*/Dijkstra searches on small networks.
+  static void set_allPairsTable(bool v) { allPairsTable_ = v; }
+  static bool allPairsTable() { return allPairsTable_; }
+  static void set_allPairsMaxNodes(unsigned v) { allPairsMaxNodes_ = v; }
+  static unsigned allPairsMaxNodes() { return allPairsMaxNodes_; }
+  // Route through the motorway/highway layer between the endpoints' streets;
+  // takes precedence over isDijkstra.
+  static void set_hierarchicalRouting(bool v) { hierarchicalRouting_ = v; }
+  static bool hierarchicalRouting() { return hierarchicalRouting_; }
+  static void set_hierarchyLocalRadius(double v) { hierarchyLocalRadius_ = v; }
+  static double hierarchyLocalRadius() { return hierarchyLocalRadius_; }
+  static void set_hierarchySuboptimality(double v) {
+    hierarchySuboptimality_ = v;
+  }
+  static double hierarchySuboptimality() { return hierarchySuboptimality_; }
+  // Price A*/Dijkstra routes with forecast loads at the time of arrival.
+  static void set_timeDependentRouting(bool v) { timeDependentRouting_ = v; }
+  static bool timeDependentRouting() { return timeDependentRouting_; }
+  static void set_forecastBucketSeconds(double v) {
+    forecastBucketSeconds_ = v;
+  }
+  static double forecastBucketSeconds() { return forecastBucketSeconds_; }
+  static void set_forecastHorizonBuckets(unsigned v) {
+    forecastHorizonBuckets_ = v;
+  }
+  static unsigned forecastHorizonBuckets() { return forecastHorizonBuckets_; }
+
+  static void set_asyncRerouting(bool v) { asyncRerouting_ = v; }
+  static bool asyncRerouting() { return asyncRerouting_; }
+  // Reroute searches running at once on the shared TaskScheduler.
+  static void set_rerouteWorkers(unsigned v) { rerouteWorkers_ = v; }
+  static unsigned rerouteWorkers() { return rerouteWorkers_; }
+  static void set_rerouteBudgetPerTick(unsigned v) {
+    rerouteBudgetPerTick_ = v;
+  }
+  static unsigned rerouteBudgetPerTick() { return rerouteBudgetPerTick_; }
+  static void set_rerouteBudgetMs(double v) { rerouteBudgetMs_ = v; }
+  static double rerouteBudgetMs() { return rerouteBudgetMs_; }
+
+  // Threads of the shared TaskScheduler. Read when a Simulation is
+  // constructed. Results are the same on any thread count only with
+  // asyncRerouting off and rerouteBudgetMs 0: asynchronous reroutes apply on
+  // whichever tick they finish, and the time budget is wall-clock.
+  static void set_simulationThreads(unsigned v) { simulationThreads_ = v; }
+  static unsigned simulationThreads() { return simulationThreads_; }
+  static void set_pinThreads(bool v) { pinThreads_ = v; }
+  static bool pinThreads() { return pinThreads_; }
+
+  // Move vehicles edge to edge with the event-driven queue model instead of
+  // integrating IDM every tick (see MesoscopicModel); for very large fleets.
+  static void set_mesoscopic(bool v) { mesoscopic_ = v; }
+  static bool mesoscopic() { return mesoscopic_; }
+  static void set_mesoStorageFactor(double v) { mesoStorageFactor_ = v; }
+  static double mesoStorageFactor() { return mesoStorageFactor_; }
+  static void set_mesoExitHeadway(double v) { mesoExitHeadway_ = v; }
+  static double mesoExitHeadway() { return mesoExitHeadway_; }
+  static void set_mesoStuckTime(double v) { mesoStuckTime_ = v; }
+  static double mesoStuckTime() { return mesoStuckTime_; }
 
 private:
   inline static float simulationSpeed_ = 1.0f;
+  inline static double physicsDt_ = 1.0 / 60.0;
+  inline static unsigned maxSubsteps_ = 16; // covers 10x warp at 60 fps
   inline static std::string fontPath_ = "assets/fonts/arial.ttf";
   inline static int settingsWindowHeight_ = 380;
   inline static int settingsWindowWidth_ = 520;
@@ -183,7 +276,7 @@ private:
   inline static uint32_t btnOutline_ = 0xFF5A6068;
   inline static uint32_t btnText_ = 0xFFE6EBF0;
   inline static uint32_t backgroundColor_ = 0xFF141619;
-  inline static u_int32_t vechicleColor_ = 0xFFFF0000;
+  inline static uint32_t vechicleColor_ = 0xFFFF0000;
 
   inline static int targetNodes_ = 30;
   inline static int minDistPx_ = 30;
@@ -201,6 +294,35 @@ private:
   inline static int streetCapacity_ = 1;
 
   inline static bool isDijkstra_ = false;
+  inline static bool incrementalRouting_ = false;
+  inline static bool adaptiveRouting_ = false;
+  inline static bool destinationTreeCache_ = true;
+  inline static unsigned destinationCacheSize_ = 32; // goals per class
+  inline static unsigned destinationCacheMinDemand_ = 2;
+  inline static double astarWeight_ = 1.0;    // 1 = optimal
+  inline static double astarWeightMax_ = 3.0; // settings slider range
+  inline static unsigned routeQualitySampleEvery_ = 64;
+  inline static bool allPairsTable_ = true;
+  inline static unsigned allPairsMaxNodes_ = 512; // 2 MiB of times per class
+  inline static bool hierarchicalRouting_ = false;
+  inline static double hierarchyLocalRadius_ = 250.0; // px around endpoints
+  inline static double hierarchySuboptimality_ = 0.0; // 0 = exact
+  inline static bool timeDependentRouting_ = false;
+  inline static double forecastBucketSeconds_ = 5.0;
+  inline static unsigned forecastHorizonBuckets_ = 24;
+
+  inline static bool asyncRerouting_ = true;
+  inline static unsigned rerouteWorkers_ = 2;
+  inline static unsigned rerouteBudgetPerTick_ = 32; // 0 = unlimited
+  inline static double rerouteBudgetMs_ = 2.0;       // 0 = unlimited
+
+  inline static unsigned simulationThreads_ = 0; // 0 = hardware concurrency
+  inline static bool pinThreads_ = false;        // Linux only
+
+  inline static bool mesoscopic_ = false;
+  inline static double mesoStorageFactor_ = 4.0; // x road capacity
+  inline static double mesoExitHeadway_ = 1.0;   // seconds
+  inline static double mesoStuckTime_ = 10.0;    // seconds
 };
 
 #endif // PARAMETERS_H
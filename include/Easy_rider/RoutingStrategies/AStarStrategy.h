@@ -1,29 +1,62 @@
 /**
  * @file AStarStrategy.h
- * @brief A* shortest-time strategy with injected time function and heuristic.
+ * @brief A* shortest-time strategy over an EdgeTimeTable snapshot.
  */
 #ifndef ASTAR_STRATEGY_H
 #define ASTAR_STRATEGY_H
 
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "RouteQualityLog.h"
 #include "RouteStrategy.h"
 #include "RoutingCommon.h"
 
+#include <cstddef>
+
 /**
  * @class AStarStrategy
  * @brief A* using:
- *  - g(uIdx -> vIdx)  = timeFn(edge)
- *  - h(uIdx)          = euclidean(pos[u], pos[goal]) / vmaxUpperBound
+ *  - g(uIdx -> vIdx)  = times.travelTime(classIdx, edge)
+ *  - h(uIdx)          = euclidean(pos[u], pos[goal]) /
+ *                       times.vmaxUpperBound(classIdx)
+ *  - f(uIdx)          = g(uIdx) + weight * h(uIdx)
+ *
+ * @details
+ * With weight 1 the route is optimal. A weight w > 1 searches greedier
+ * toward the goal and settles fewer nodes. Since h is consistent, the route
+ * still costs at most w times the optimum, even though closed nodes are never
+ * reopened. When a RouteQualityLog is given, every search is recorded, and
+ * the searches it samples are re-solved with Dijkstra to measure the actual
+ * cost ratio.
  */
 class AStarStrategy final : public RouteStrategy {
 public:
-  explicit AStarStrategy(EdgeTimeFn timeFn) : timeFn_(timeFn) {}
+  /**
+   * @param times    Per-tick edge time snapshot (must outlive the strategy).
+   * @param classIdx Vehicle class whose travel times are used as weights.
+   * @param weight   Heuristic weight w >= 1 (suboptimality bound).
+   * @param log      Optional record of settled nodes and cost ratios.
+   */
+  AStarStrategy(const EdgeTimeTable &times, std::size_t classIdx,
+                double weight = 1.0, RouteQualityLog *log = nullptr)
+      : times_(&times), classIdx_(classIdx),
+        weight_(weight < 1.0 ? 1.0 : weight), log_(log) {}
 
   std::vector<int>
   computeRoute(int startId, int goalId,
-               const Graph<Intersection, Road> &graph) override;
+               const Graph<Intersection, Road> &graph) override {
+    return search(startId, goalId, graph).route;
+  }
+
+  /// @brief computeRoute(), also reporting the nodes settled.
+  [[nodiscard]] SearchResult
+  search(int startId, int goalId,
+         const Graph<Intersection, Road> &graph) const;
 
 private:
-  EdgeTimeFn timeFn_;
+  const EdgeTimeTable *times_;
+  std::size_t classIdx_;
+  double weight_;
+  RouteQualityLog *log_;
 };
 
 #endif // ASTAR_STRATEGY_H
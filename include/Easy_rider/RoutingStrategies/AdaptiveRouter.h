@@ -0,0 +1,114 @@
+/**
+ * @file AdaptiveRouter.h
+ * @brief Per-query choice between routing engines from an online cost model.
+ */
+#ifndef ADAPTIVE_ROUTER_H
+#define ADAPTIVE_ROUTER_H
+
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "HierarchicalStrategy.h"
+#include "RoutingCommon.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class AllPairsRouter;
+class DestinationTreeCache;
+
+/// Engines an AdaptiveRouter chooses from.
+enum class RouteEngine : std::uint8_t {
+  AStar,         ///< Unidirectional A*.
+  Bidirectional, ///< Bidirectional Dijkstra.
+  Tree,          ///< All-pairs table or destination tree, A* on a miss.
+  Hierarchy,     ///< Motorway/highway layer between local streets.
+};
+
+/// Number of RouteEngine values.
+inline constexpr std::size_t kRouteEngineCount = 4;
+
+/**
+ * @class AdaptiveRouter
+ * @brief Routes each query with the engine expected to answer it fastest.
+ *
+ * @details
+ * Queries are grouped by the straight-line distance between their endpoints,
+ * as a fraction of the network's extent, into kDistanceBuckets buckets. Each
+ * router serves one network, so the graph size is the same for every query
+ * it sees. Each (bucket, engine) cell keeps an exponential moving average of
+ * measured wall time. A query runs the engine with the lowest average. Each
+ * engine is first tried kWarmup times per bucket. Every kExploreEvery-th
+ * query of a bucket runs the engine that has gone longest unused, so the
+ * averages follow congestion and cache warm-up.
+ *
+ * Tree is only offered when a table or cache is attached, and Hierarchy only
+ * when the network has motorways or highways. A Tree miss falls back to A*,
+ * and that time is charged to Tree.
+ *
+ * Thread-safe: route() can be called from reroute workers concurrently with
+ * the simulation thread.
+ */
+class AdaptiveRouter {
+public:
+  static constexpr std::size_t kDistanceBuckets = 4;
+  static constexpr std::uint32_t kWarmup = 3;
+  static constexpr std::uint64_t kExploreEvery = 32;
+
+  /**
+   * @param graph     Road network (must outlive the router).
+   * @param classIdx  Vehicle class whose travel times are used as weights.
+   * @param allPairs  Table used by RouteEngine::Tree (can be null).
+   * @param cache     Destination trees used by RouteEngine::Tree (can be
+   *                  null).
+   * @param hierarchy Options of RouteEngine::Hierarchy.
+   */
+  AdaptiveRouter(const Graph<Intersection, Road> &graph, std::size_t classIdx,
+                 AllPairsRouter *allPairs, DestinationTreeCache *cache,
+                 HierarchyOptions hierarchy = {});
+
+  AdaptiveRouter(const AdaptiveRouter &) = delete;
+  AdaptiveRouter &operator=(const AdaptiveRouter &) = delete;
+
+  /// @brief Route startId -> goalId over @p times and record the latency.
+  std::vector<int> route(const EdgeTimeTable &times, int startId, int goalId);
+
+  /// @return Whether @p engine can be chosen on this network.
+  [[nodiscard]] bool available(RouteEngine engine) const;
+
+  /// @return Queries answered by each engine (index = RouteEngine).
+  [[nodiscard]] std::array<std::uint64_t, kRouteEngineCount>
+  histogram() const;
+
+  /// @return Average seconds of @p engine in @p bucket (0 if never run).
+  [[nodiscard]] double latency(RouteEngine engine, std::size_t bucket) const;
+
+private:
+  struct Cell {
+    double seconds{0.0};       ///< Moving average of wall time.
+    std::uint32_t samples{0};  ///< Measurements taken.
+    std::uint64_t lastUsed{0}; ///< Bucket query number of the last use.
+  };
+
+  [[nodiscard]] std::size_t bucketOf(int startId, int goalId) const;
+  RouteEngine choose(std::size_t bucket);
+  void record(std::size_t bucket, RouteEngine engine, double seconds);
+  std::vector<int> run(RouteEngine engine, const EdgeTimeTable &times,
+                       int startId, int goalId);
+
+  const Graph<Intersection, Road> &graph_;
+  std::size_t classIdx_;
+  AllPairsRouter *allPairs_;
+  DestinationTreeCache *cache_;
+  HierarchyOptions hierarchy_;
+  bool hasLayers_{false}; ///< Network has motorways or highways.
+  double extent_{1.0};    ///< Diagonal of the node bounding box.
+
+  mutable std::mutex mutex_;
+  std::array<std::array<Cell, kRouteEngineCount>, kDistanceBuckets> model_{};
+  std::array<std::uint64_t, kDistanceBuckets> queries_{};
+  std::array<std::uint64_t, kRouteEngineCount> histogram_{};
+};
+
+#endif // ADAPTIVE_ROUTER_H
@@ -0,0 +1,36 @@
+/**
+ * @file AdaptiveStrategy.h
+ * @brief RouteStrategy that lets an AdaptiveRouter pick the engine per query.
+ */
+#ifndef ADAPTIVE_STRATEGY_H
+#define ADAPTIVE_STRATEGY_H
+
+#include "AdaptiveRouter.h"
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "RouteStrategy.h"
+
+/**
+ * @class AdaptiveStrategy
+ * @brief Forwards each query to the class's shared AdaptiveRouter.
+ */
+class AdaptiveStrategy final : public RouteStrategy {
+public:
+  /**
+   * @param router Shared router for the vehicle's class (must outlive this).
+   * @param times  Per-tick edge time snapshot (must outlive this).
+   */
+  AdaptiveStrategy(AdaptiveRouter &router, const EdgeTimeTable &times)
+      : router_(&router), times_(&times) {}
+
+  std::vector<int>
+  computeRoute(int startId, int goalId,
+               const Graph<Intersection, Road> & /*graph*/) override {
+    return router_->route(*times_, startId, goalId);
+  }
+
+private:
+  AdaptiveRouter *router_;
+  const EdgeTimeTable *times_;
+};
+
+#endif // ADAPTIVE_STRATEGY_H
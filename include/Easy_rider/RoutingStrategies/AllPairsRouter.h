@@ -0,0 +1,151 @@
+/**
+ * @file AllPairsRouter.h
+ * @brief Dense all-pairs travel-time and next-hop tables for small networks.
+ */
+#ifndef ALL_PAIRS_ROUTER_H
+#define ALL_PAIRS_ROUTER_H
+
+#include "Easy_rider/Concurrency/TaskScheduler.h"
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "RoutingCommon.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+/**
+ * @struct AllPairsTable
+ * @brief n x n shortest travel times and first hops, row-major.
+ *
+ * dist[i * n + j] is the travel time from node index i to j (+inf if
+ * unreachable) and next[i * n + j] the node after i on that route (-1 if
+ * none; i itself on the diagonal).
+ */
+struct AllPairsTable {
+  std::size_t n{0};
+  std::vector<double> dist;
+  std::vector<std::int32_t> next;
+  std::uint64_t epoch{0}; ///< EdgeTimeTable epoch of the weights used.
+
+  /**
+   * @brief Blocked Floyd-Warshall over directed edges from[e] -> to[e].
+   *
+   * The min-plus inner loop is branch-free over contiguous rows, so the
+   * compiler can vectorise it. Blocks of kBlock x kBlock doubles keep the
+   * three operand tiles in L1.
+   */
+  static AllPairsTable build(std::size_t n, const std::vector<int> &from,
+                             const std::vector<int> &to, EdgeTimes weights);
+
+  /**
+   * @brief Account for edge u -> v getting cheaper (now @p w). O(n^2).
+   * Only valid for decreases of a table that was exact before.
+   */
+  void lowerEdge(int u, int v, double w);
+
+  /// @return Node indices i ... j (empty if unreachable).
+  [[nodiscard]] std::vector<int> pathIndices(int i, int j) const;
+
+  static constexpr std::size_t kBlock = 32;
+};
+
+/**
+ * @class AllPairsRouter
+ * @brief Keeps one class's AllPairsTable current and answers routes by
+ * walking next hops, with no search.
+ *
+ * @details
+ * sync() compares the class's weights with the last snapshot. When only a few
+ * edges got cheaper, a copy of the table is patched with lowerEdge() and
+ * published. Any other change leaves the table stale. A stale table answers
+ * nothing: tryRoute() returns std::nullopt, so the caller runs its own
+ * search. Once the misses add up to roughly the cost of one rebuild (n^2/128
+ * queries), a rebuild is started. With a scheduler it runs as a task there.
+ * Otherwise it runs in the next sync(). Under heavy congestion churn
+ * the router therefore falls back to plain searches instead of rebuilding
+ * O(n^3) tables every tick.
+ *
+ * Tables are immutable once published, and tryRoute() is safe from any
+ * thread.
+ */
+class AllPairsRouter {
+public:
+  /**
+   * @param graph     Road network (must outlive the router).
+   * @param classIdx  Vehicle class whose travel times are used as weights.
+   * @param scheduler Pool to rebuild on (must outlive the router); null
+   *                  rebuilds inside sync().
+   */
+  AllPairsRouter(const Graph<Intersection, Road> &graph, std::size_t classIdx,
+                 TaskScheduler *scheduler = nullptr);
+  ~AllPairsRouter();
+
+  AllPairsRouter(const AllPairsRouter &) = delete;
+  AllPairsRouter &operator=(const AllPairsRouter &) = delete;
+
+  /// @brief Bring the table up to date with @p times (see class notes).
+  void sync(const EdgeTimeTable &times);
+
+  /**
+   * @return Node ids startId ... goalId (empty if unreachable), or
+   * std::nullopt if the table is stale or was built for another graph.
+   */
+  [[nodiscard]] std::optional<std::vector<int>> tryRoute(int startId,
+                                                         int goalId);
+
+  /// @return The published table, possibly stale (null before sync()).
+  [[nodiscard]] std::shared_ptr<const AllPairsTable> table() const;
+
+  /// @return Full table builds published so far.
+  [[nodiscard]] std::uint64_t rebuilds() const;
+
+  /// @return Syncs answered by patching the table.
+  [[nodiscard]] std::uint64_t patches() const;
+
+  /// @return Routes answered from the table.
+  [[nodiscard]] std::uint64_t hits() const;
+
+private:
+  // Largest number of cheaper edges patched instead of going stale.
+  static constexpr std::size_t kMaxPatchedEdges = 8;
+
+  void reset(const EdgeTimeTable &times);
+  // Patch or mark stale after weights_ changed on the edges in diff_.
+  void applyChanges(bool onlyCheaper);
+  void publish(std::shared_ptr<const AllPairsTable> table);
+  // Body of the rebuild task: build tables until no request is pending.
+  void rebuildLoop();
+
+  const Graph<Intersection, Road> &graph_;
+  std::size_t classIdx_;
+
+  // Simulation-thread state; the topology is only written under mutex_.
+  std::vector<int> from_, to_;    ///< Edge endpoints (node indices).
+  std::size_t nodeCount_{0};      ///< Node count of from_/to_.
+  std::vector<double> weights_;   ///< Class row at epoch_.
+  std::uint64_t epoch_{0};        ///< Epoch of weights_.
+  bool synced_{false};            ///< Set by the first sync().
+  std::vector<std::size_t> diff_; ///< Scratch: edges that changed.
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<const AllPairsTable> current_{}; ///< Published table.
+  std::vector<double> latestWeights_;              ///< Copy for rebuilds.
+  std::uint64_t latestEpoch_{0}; ///< Table is fresh iff epoch matches.
+  std::size_t misses_{0};        ///< Stale queries since last publish.
+  bool rebuildRequested_{false};
+  bool rebuildDue_{false}; ///< Foreground rebuild for the next sync().
+  std::optional<std::vector<double>> pending_{}; ///< Weights to rebuild.
+  std::uint64_t pendingEpoch_{0};
+  bool building_{false}; ///< A rebuild task is queued or running.
+  bool stopping_{false}; ///< Set by the destructor.
+  std::uint64_t rebuilds_{0};
+  std::uint64_t patches_{0};
+  std::atomic<std::uint64_t> hits_{0};
+  std::optional<TaskGroup> builds_{}; ///< Last member: waited for first.
+};
+
+#endif // ALL_PAIRS_ROUTER_H
@@ -0,0 +1,42 @@
+/**
+ * @file AllPairsStrategy.h
+ * @brief RouteStrategy that walks an AllPairsRouter table.
+ */
+#ifndef ALL_PAIRS_STRATEGY_H
+#define ALL_PAIRS_STRATEGY_H
+
+#include "AllPairsRouter.h"
+#include "RouteStrategy.h"
+
+#include <memory>
+#include <utility>
+
+/**
+ * @class AllPairsStrategy
+ * @brief Follows next hops of the class's all-pairs table, and delegates to a
+ * search strategy while no table matches the graph.
+ */
+class AllPairsStrategy final : public RouteStrategy {
+public:
+  /**
+   * @param router   Shared router for the vehicle's class (must outlive this).
+   * @param fallback Strategy used when the router has no table.
+   */
+  AllPairsStrategy(AllPairsRouter &router,
+                   std::unique_ptr<RouteStrategy> fallback)
+      : router_(&router), fallback_(std::move(fallback)) {}
+
+  std::vector<int>
+  computeRoute(int startId, int goalId,
+               const Graph<Intersection, Road> &graph) override {
+    if (auto route = router_->tryRoute(startId, goalId))
+      return std::move(*route);
+    return fallback_->computeRoute(startId, goalId, graph);
+  }
+
+private:
+  AllPairsRouter *router_;
+  std::unique_ptr<RouteStrategy> fallback_;
+};
+
+#endif // ALL_PAIRS_STRATEGY_H
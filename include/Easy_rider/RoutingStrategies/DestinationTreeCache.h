@@ -0,0 +1,105 @@
+/**
+ * @file DestinationTreeCache.h
+ * @brief Shared reverse shortest-path trees for frequently requested goals.
+ */
+#ifndef DESTINATION_TREE_CACHE_H
+#define DESTINATION_TREE_CACHE_H
+
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "RoutingCommon.h"
+#include "ShortestPathTree.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class DestinationTreeCache
+ * @brief Per-class cache of trees answering "next hop toward goal" for every
+ * node.
+ *
+ * @details
+ * A goal is cached once it has been asked for @c minDemand times. Its tree is
+ * one reverse Dijkstra over the weights of the last sync(). After that, any
+ * route to it is found by following next-hop pointers, in O(route length)
+ * with no search. When the edge time snapshot moves to a new epoch, the trees
+ * are marked stale and each one is regrown on its next use. Goals nobody asks
+ * for again therefore cost nothing.
+ *
+ * All public methods are thread-safe, so tryRoute() can be called from
+ * reroute workers while the simulation thread calls sync(). The internal
+ * mutex only guards the bookkeeping. Trees and weights are immutable once
+ * published, so routes are read from them outside the lock. A stale tree is
+ * regrown outside the lock too, by the first caller that needs it, and
+ * swapped in when done. Callers asking for that goal meanwhile wait for it,
+ * since following the new tree is cheaper than searching. Callers asking
+ * for other goals are not held up.
+ */
+class DestinationTreeCache {
+public:
+  /**
+   * @param graph     Road network (must outlive the cache).
+   * @param classIdx  Vehicle class whose travel times are used as weights.
+   * @param maxTrees  Cached goals; the least recently used one is evicted.
+   * @param minDemand Requests for a goal before its tree is built.
+   */
+  DestinationTreeCache(const Graph<Intersection, Road> &graph,
+                       std::size_t classIdx, std::size_t maxTrees = 32,
+                       std::uint32_t minDemand = 2);
+
+  DestinationTreeCache(const DestinationTreeCache &) = delete;
+  DestinationTreeCache &operator=(const DestinationTreeCache &) = delete;
+
+  /// @brief Copy the class's weights if @p times moved to a new epoch.
+  void sync(const EdgeTimeTable &times);
+
+  /**
+   * @brief Route by next-hop pointers if @p goalId is (or just became) cached.
+   * @return Node ids startId ... goalId (empty if unreachable), or
+   * std::nullopt if the goal is not popular enough to be cached yet.
+   */
+  std::optional<std::vector<int>> tryRoute(int startId, int goalId);
+
+  /// @return Goals currently cached.
+  [[nodiscard]] std::size_t cachedGoals() const;
+
+  /// @return Routes answered from a cached tree.
+  [[nodiscard]] std::uint64_t hits() const;
+
+  /// @return Trees grown (first builds and epoch refreshes).
+  [[nodiscard]] std::uint64_t rebuilds() const;
+
+private:
+  struct Entry {
+    std::shared_ptr<const ShortestPathTree> tree{}; ///< Null until grown.
+    std::optional<std::uint64_t> grownAt{}; ///< Weights epoch of the tree.
+    std::optional<std::uint64_t> growing{}; ///< Epoch being grown, if any.
+    std::uint64_t lastUsed{0};              ///< LRU clock value.
+  };
+
+  // Entry for goalIdx (possibly stale), or null if not popular yet.
+  Entry *entryFor(int goalIdx);
+
+  const Graph<Intersection, Road> &graph_;
+  std::size_t classIdx_;
+  std::size_t maxTrees_;
+  std::uint32_t minDemand_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable grown_; ///< Signalled when a regrowth finishes.
+  std::shared_ptr<const std::vector<double>> weights_{}; ///< Class row.
+  std::uint64_t epoch_{0};                        ///< Epoch of weights_.
+  bool synced_{false};                            ///< Set by first sync().
+  std::uint64_t useClock_{0};                     ///< LRU clock.
+  std::uint64_t hits_{0};                         ///< Telemetry.
+  std::uint64_t rebuilds_{0};                     ///< Telemetry.
+  std::unordered_map<int, std::uint32_t> demand_; ///< goalIdx -> requests.
+  std::unordered_map<int, Entry> entries_;        ///< goalIdx -> tree.
+};
+
+#endif // DESTINATION_TREE_CACHE_H
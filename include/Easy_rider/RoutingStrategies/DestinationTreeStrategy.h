@@ -0,0 +1,42 @@
+/**
+ * @file DestinationTreeStrategy.h
+ * @brief RouteStrategy that answers popular goals from a DestinationTreeCache.
+ */
+#ifndef DESTINATION_TREE_STRATEGY_H
+#define DESTINATION_TREE_STRATEGY_H
+
+#include "DestinationTreeCache.h"
+#include "RouteStrategy.h"
+
+#include <memory>
+#include <utility>
+
+/**
+ * @class DestinationTreeStrategy
+ * @brief Follows cached next-hop pointers when the goal is cached, and
+ * otherwise delegates to a search strategy.
+ */
+class DestinationTreeStrategy final : public RouteStrategy {
+public:
+  /**
+   * @param cache    Shared cache for the vehicle's class (must outlive this).
+   * @param fallback Strategy used for goals that are not cached.
+   */
+  DestinationTreeStrategy(DestinationTreeCache &cache,
+                          std::unique_ptr<RouteStrategy> fallback)
+      : cache_(&cache), fallback_(std::move(fallback)) {}
+
+  std::vector<int>
+  computeRoute(int startId, int goalId,
+               const Graph<Intersection, Road> &graph) override {
+    if (auto route = cache_->tryRoute(startId, goalId))
+      return std::move(*route);
+    return fallback_->computeRoute(startId, goalId, graph);
+  }
+
+private:
+  DestinationTreeCache *cache_;
+  std::unique_ptr<RouteStrategy> fallback_;
+};
+
+#endif // DESTINATION_TREE_STRATEGY_H
@@ -1,32 +1,48 @@
 /**
  * @file DijkstraStrategy.h
- * @brief Dijkstra shortest-time strategy with injected time function.
+ * @brief Dijkstra shortest-time strategy over an EdgeTimeTable snapshot.
  */
 #ifndef DIJKSTRA_STRATEGY_H
 #define DIJKSTRA_STRATEGY_H
 
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
 #include "RouteStrategy.h"
 #include "RoutingCommon.h"
 
+#include <cstddef>
+
 /**
  * @class DijkstraStrategy
  * @brief Dijkstra using a min-heap; edge weight is always travel time.
  *
  * @details
- * Edge time is provided by an external function:
- *   w(uIdx -> vIdx) = timeFn(edge)
+ * Edge time is read from the per-tick snapshot:
+ *   w(uIdx -> vIdx) = times.travelTime(classIdx, edge)
  * The strategy works on node indices and returns node ids at the end.
  */
 class DijkstraStrategy final : public RouteStrategy {
 public:
-  explicit DijkstraStrategy(EdgeTimeFn timeFn) : timeFn_(timeFn) {}
+  /**
+   * @param times    Per-tick edge time snapshot (must outlive the strategy).
+   * @param classIdx Vehicle class whose travel times are used as weights.
+   */
+  DijkstraStrategy(const EdgeTimeTable &times, std::size_t classIdx)
+      : times_(&times), classIdx_(classIdx) {}
 
   std::vector<int>
   computeRoute(int startId, int goalId,
-               const Graph<Intersection, Road> &graph) override;
+               const Graph<Intersection, Road> &graph) override {
+    return search(startId, goalId, graph).route;
+  }
+
+  /// @brief computeRoute(), also reporting the nodes settled.
+  [[nodiscard]] SearchResult
+  search(int startId, int goalId,
+         const Graph<Intersection, Road> &graph) const;
 
 private:
-  EdgeTimeFn timeFn_;
+  const EdgeTimeTable *times_;
+  std::size_t classIdx_;
 };
 
 #endif // DIJKSTRA_STRATEGY_H
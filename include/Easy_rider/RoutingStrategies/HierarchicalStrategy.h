@@ -0,0 +1,73 @@
+/**
+ * @file HierarchicalStrategy.h
+ * @brief Bidirectional search that leaves the street layer near the endpoints.
+ */
+#ifndef HIERARCHICAL_STRATEGY_H
+#define HIERARCHICAL_STRATEGY_H
+
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "RouteStrategy.h"
+#include "RoutingCommon.h"
+
+#include <cstddef>
+
+/// @brief Tuning of HierarchicalStrategy.
+struct HierarchyOptions {
+  double localRadius{250.0};    ///< Street neighbourhood of start/goal (px).
+  double maxSuboptimality{0.0}; ///< Allowed relative excess (0 = exact).
+};
+
+/**
+ * @class HierarchicalStrategy
+ * @brief Shortest-time routing over the road-class hierarchy.
+ *
+ * @details
+ * Street edges are only searched if one of their endpoints lies within
+ * localRadius (Euclidean) of the start or the goal. Motorway and highway
+ * edges are always searched. The generators make the highway layer span the
+ * network, so long trips cross the middle on the upper layer and settle a
+ * small part of the graph. A bidirectional Dijkstra runs over this subgraph.
+ * If it holds no path, the search is repeated over the full graph. An
+ * infinite localRadius skips the subgraph and gives a plain bidirectional
+ * Dijkstra.
+ *
+ * With maxSuboptimality = eps > 0 the search stops as soon as
+ * (1 + eps) * (top of forward + top of backward queue) >= best route, so the
+ * result costs at most (1 + eps) times the best route in the subgraph.
+ */
+class HierarchicalStrategy final : public RouteStrategy {
+public:
+  /**
+   * @param times    Per-tick edge time snapshot (must outlive this).
+   * @param classIdx Vehicle class whose travel times are used.
+   * @param options  Street radius and allowed suboptimality.
+   */
+  HierarchicalStrategy(const EdgeTimeTable &times, std::size_t classIdx,
+                       HierarchyOptions options = {})
+      : times_(&times), classIdx_(classIdx), options_(options) {}
+
+  std::vector<int>
+  computeRoute(int startId, int goalId,
+               const Graph<Intersection, Road> &graph) override {
+    return search(startId, goalId, graph).route;
+  }
+
+  /// @brief computeRoute(), also reporting the nodes settled (both
+  /// directions, over both passes).
+  [[nodiscard]] SearchResult
+  search(int startId, int goalId,
+         const Graph<Intersection, Road> &graph) const;
+
+private:
+  // One bidirectional search; restricted to the hierarchy if @p restrict.
+  // Adds the nodes it settles to @p settled.
+  std::vector<int> searchLayer(int sIdx, int gIdx,
+                               const Graph<Intersection, Road> &graph,
+                               bool restrict, std::size_t &settled) const;
+
+  const EdgeTimeTable *times_;
+  std::size_t classIdx_;
+  HierarchyOptions options_;
+};
+
+#endif // HIERARCHICAL_STRATEGY_H
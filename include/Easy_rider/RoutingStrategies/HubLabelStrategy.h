@@ -0,0 +1,45 @@
+/**
+ * @file HubLabelStrategy.h
+ * @brief RouteStrategy answering queries from a shared HubLabelIndex.
+ */
+#ifndef HUB_LABEL_STRATEGY_H
+#define HUB_LABEL_STRATEGY_H
+
+#include "HubLabels.h"
+#include "RouteStrategy.h"
+
+#include <memory>
+#include <utility>
+
+/**
+ * @class HubLabelStrategy
+ * @brief Shortest-time routes under the index's fixed (e.g. free-flow)
+ * weights; congestion is ignored by construction.
+ *
+ * Falls back to an empty route if the index was built for another graph.
+ */
+class HubLabelStrategy final : public RouteStrategy {
+public:
+  /// @param index Labels shared by all vehicles that use them.
+  explicit HubLabelStrategy(std::shared_ptr<const HubLabelIndex> index)
+      : index_(std::move(index)) {}
+
+  std::vector<int>
+  computeRoute(int startId, int goalId,
+               const Graph<Intersection, Road> &graph) override {
+    if (!index_ || !index_->covers(graph) || !graph.hasId(startId) ||
+        !graph.hasId(goalId))
+      return {};
+    std::vector<int> path =
+        index_->pathIndices(static_cast<int>(graph.indexOfId(startId)),
+                            static_cast<int>(graph.indexOfId(goalId)));
+    for (int &v : path)
+      v = graph.getNodes()[static_cast<std::size_t>(v)].getId();
+    return path;
+  }
+
+private:
+  std::shared_ptr<const HubLabelIndex> index_;
+};
+
+#endif // HUB_LABEL_STRATEGY_H
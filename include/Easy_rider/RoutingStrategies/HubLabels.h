@@ -0,0 +1,128 @@
+/**
+ * @file HubLabels.h
+ * @brief Hub-label distance index for fixed weights, storable as a flat file.
+ */
+#ifndef HUB_LABELS_H
+#define HUB_LABELS_H
+
+#include "RoutingCommon.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class HubLabelIndex
+ * @brief Two-hop labels answering shortest-time queries by a sorted merge.
+ *
+ * @details
+ * Every node v stores an out-label (hubs v reaches, with distances) and an
+ * in-label (hubs that reach v). dist(s, t) is the minimum of
+ * out(s)[h] + in(t)[h] over the hubs the two labels share. Labels are sorted
+ * by hub rank, so a query is one linear merge.
+ *
+ * build() orders nodes by contraction (edge difference plus contracted
+ * neighbours, with bounded witness searches). It then runs pruned Dijkstra
+ * searches from the most important node down. Each entry also stores its
+ * neighbour toward the hub, so paths are unpacked without any search.
+ *
+ * The index is one flat, 8-byte aligned block: header, label offsets, label
+ * entries, and the hub -> node table. save() writes that block unchanged, and
+ * open() maps a saved file read-only with mmap where POSIX provides it, and
+ * reads it into memory elsewhere. Either way loading costs no parsing, only
+ * one pass that checks every offset, hub and link is in range. The header
+ * carries fingerprints of the network and of the weights, so matches() can
+ * tell a file built for another network, or another vehicle class, from the
+ * right one. The weights are fixed at build time. Rebuild
+ * or reopen the index when the network or its free-flow speeds change.
+ */
+class HubLabelIndex {
+public:
+  /// @brief Size and cost figures of an index.
+  struct Stats {
+    std::size_t nodes{0};      ///< Nodes covered.
+    std::size_t outEntries{0}; ///< Entries over all out-labels.
+    std::size_t inEntries{0};  ///< Entries over all in-labels.
+    std::size_t maxLabel{0};   ///< Largest single label.
+    double avgLabel{0.0};      ///< Mean entries per label.
+    std::size_t bytes{0};      ///< Size of the flat block / file.
+    double buildSeconds{0.0};  ///< Wall time of build().
+  };
+
+  /**
+   * @brief Build labels for @p graph under fixed edge @p weights.
+   * @param graph   Road network (only read during the build).
+   * @param weights Travel time per edge, indexed like Graph::getEdges().
+   */
+  static HubLabelIndex build(const Graph<Intersection, Road> &graph,
+                             EdgeTimes weights);
+
+  /**
+   * @brief Map an index written by save().
+   * @return The index, or std::nullopt if the file is missing, truncated,
+   * inconsistent or not a hub-label file of this version.
+   */
+  static std::optional<HubLabelIndex> open(const std::string &path);
+
+  HubLabelIndex(HubLabelIndex &&other) noexcept;
+  HubLabelIndex &operator=(HubLabelIndex &&other) noexcept;
+  HubLabelIndex(const HubLabelIndex &) = delete;
+  HubLabelIndex &operator=(const HubLabelIndex &) = delete;
+  ~HubLabelIndex();
+
+  /// @brief Write the flat block to @p path. @return false on I/O error.
+  bool save(const std::string &path) const;
+
+  /// @return Whether node and edge counts equal those of @p graph, so its
+  /// indices are in range (O(1); see matches()).
+  [[nodiscard]] bool covers(const Graph<Intersection, Road> &graph) const;
+
+  /// @return Whether the index was built for @p graph under @p weights
+  /// (O(edges)).
+  [[nodiscard]] bool matches(const Graph<Intersection, Road> &graph,
+                             EdgeTimes weights) const;
+
+  /// @return Shortest time from node index @p sIdx to @p gIdx (inf if none).
+  [[nodiscard]] double distance(int sIdx, int gIdx) const;
+
+  /// @return Node indices sIdx ... gIdx of a shortest path (empty if none).
+  [[nodiscard]] std::vector<int> pathIndices(int sIdx, int gIdx) const;
+
+  /// @return Label sizes, block size and build time.
+  [[nodiscard]] Stats stats() const;
+
+private:
+  struct Header;
+  struct Entry;
+
+  HubLabelIndex() = default;
+
+  // Release the mapped file, if any.
+  void unmap() noexcept;
+  // Point the views below at a block starting with a valid Header.
+  void bind(const std::byte *block);
+  // Whether the bound sections are consistent with the header.
+  [[nodiscard]] bool wellFormed() const;
+  // Best (distance, hub rank) of the merge; rank is -1 if unreachable.
+  [[nodiscard]] std::pair<double, std::int64_t> query(int sIdx,
+                                                      int gIdx) const;
+  // Entry for hub rank @p hub in [first, last), or null.
+  static const Entry *find(const Entry *first, const Entry *last,
+                           std::uint32_t hub);
+
+  std::vector<std::uint64_t> owned_{}; ///< Block built or read in memory.
+  void *map_{nullptr};                 ///< Block of a mapped file.
+  std::size_t mapBytes_{0};
+
+  const Header *header_{nullptr};
+  const std::uint64_t *outOffsets_{nullptr}; ///< n + 1 offsets.
+  const std::uint64_t *inOffsets_{nullptr};  ///< n + 1 offsets.
+  const Entry *outEntries_{nullptr};
+  const Entry *inEntries_{nullptr};
+  const std::uint32_t *hubNode_{nullptr}; ///< Hub rank -> node index.
+};
+
+#endif // HUB_LABELS_H
@@ -0,0 +1,123 @@
+/**
+ * @file IncrementalRouter.h
+ * @brief Per-goal shortest-path trees repaired incrementally (LPA* / D* Lite)
+ * when edge travel times change.
+ */
+#ifndef INCREMENTAL_ROUTER_H
+#define INCREMENTAL_ROUTER_H
+
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "RoutingCommon.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class IncrementalRouter
+ * @brief Shared cache of goal-rooted search trees for one vehicle class.
+ *
+ * @details
+ * Each cached goal keeps a backward LPA* tree: g(v) is the travel time from v
+ * to the goal and rhs(v) its one-step lookahead. A query from a start node
+ * only expands nodes until that start is locally consistent, so the tree
+ * grows lazily as vehicles with the same destination ask for routes from new
+ * places.
+ *
+ * When the edge time snapshot moves to a new epoch, sync() feeds the changed
+ * edges into every cached tree (D* Lite's edge-cost update step). The actual
+ * repair is deferred to the next query of that goal and only touches nodes
+ * whose distance really changed, so a reroute after a few congestion tier
+ * changes costs a small fraction of a fresh search.
+ *
+ * The heuristic is zero so one tree serves every start node; this makes the
+ * search a dynamic Dijkstra rather than a goal-directed one.
+ *
+ * All public methods are thread-safe (one internal mutex), so route() can be
+ * called from reroute workers while the simulation thread calls sync().
+ */
+class IncrementalRouter {
+public:
+  /**
+   * @param graph    Road network (must outlive the router).
+   * @param classIdx Vehicle class whose travel times are used as weights.
+   * @param maxTrees Cached goals; the least recently used one is evicted.
+   */
+  IncrementalRouter(const Graph<Intersection, Road> &graph,
+                    std::size_t classIdx, std::size_t maxTrees = 64);
+
+  IncrementalRouter(const IncrementalRouter &) = delete;
+  IncrementalRouter &operator=(const IncrementalRouter &) = delete;
+
+  /**
+   * @brief Bring edge weights up to date with @p times.
+   *
+   * Uses EdgeTimeTable::changedEdges() when the router is exactly one epoch
+   * behind, otherwise diffs all weights. Trees are dropped only if the graph
+   * size changed.
+   */
+  void sync(const EdgeTimeTable &times);
+
+  /**
+   * @brief Shortest-time route under the weights of the last sync().
+   * @return Node ids startId ... goalId; empty if unreachable or unknown ids.
+   */
+  std::vector<int> route(int startId, int goalId);
+
+  /// @return Goals currently cached.
+  [[nodiscard]] std::size_t cachedGoals() const;
+
+  /// @return Nodes expanded by all route() calls so far.
+  [[nodiscard]] std::uint64_t expansions() const;
+
+private:
+  static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+  /// Backward LPA* state for one goal.
+  struct GoalTree {
+    int goalIdx{-1};
+    std::vector<double> g;
+    std::vector<double> rhs;
+    std::vector<std::pair<double, int>> heap; ///< Lazy (key, idx) min-heap.
+    std::uint64_t lastUsed{0};
+  };
+
+  // Tree for goalIdx, created (and an old one evicted) if needed.
+  GoalTree &treeFor(int goalIdx);
+
+  // Drop all trees and size the weight arrays for the current graph.
+  void reset(const EdgeTimeTable &times);
+
+  // Copy changed weights from row; collect the changed sources in dirty_.
+  void applyChanges(EdgeTimes row, std::span<const std::size_t> edges);
+
+  void push(GoalTree &t, int idx);
+  void updateVertex(GoalTree &t, int idx);
+  void computeTo(GoalTree &t, int startIdx);
+
+  // Follow the cheapest successor from startIdx to the goal.
+  std::vector<int> extractPath(const GoalTree &t, int startIdx) const;
+
+  const Graph<Intersection, Road> &graph_;
+  std::size_t classIdx_;
+  std::size_t maxTrees_;
+
+  mutable std::mutex mutex_;
+  std::vector<double> weights_;             ///< Weights the trees agree with.
+  std::vector<int> edgeFrom_;               ///< Source node index per edge.
+  std::vector<std::size_t> diff_;           ///< Scratch: changed edges.
+  std::vector<int> dirty_;                  ///< Scratch: their sources.
+  std::size_t nodeCount_{0};                ///< Graph size at last reset.
+  std::uint64_t epoch_{0};                  ///< Snapshot epoch of weights_.
+  bool synced_{false};                      ///< Set by the first sync().
+  std::uint64_t useClock_{0};               ///< LRU clock.
+  std::uint64_t expansions_{0};             ///< Telemetry.
+  std::unordered_map<int, GoalTree> trees_; ///< goalIdx -> tree.
+};
+
+#endif // INCREMENTAL_ROUTER_H
@@ -0,0 +1,35 @@
+/**
+ * @file IncrementalStrategy.h
+ * @brief RouteStrategy adapter over a shared IncrementalRouter.
+ */
+#ifndef INCREMENTAL_STRATEGY_H
+#define INCREMENTAL_STRATEGY_H
+
+#include "IncrementalRouter.h"
+#include "RouteStrategy.h"
+
+/**
+ * @class IncrementalStrategy
+ * @brief Routes through per-goal trees that are repaired, not recomputed,
+ * when congestion changes (see IncrementalRouter).
+ *
+ * @details
+ * Weights come from the router's last sync(), not from @p graph; the owner of
+ * the router syncs it once per tick with the edge time snapshot.
+ */
+class IncrementalStrategy final : public RouteStrategy {
+public:
+  /// @param router Shared router for the vehicle's class (must outlive this).
+  explicit IncrementalStrategy(IncrementalRouter &router) : router_(&router) {}
+
+  std::vector<int>
+  computeRoute(int startId, int goalId,
+               const Graph<Intersection, Road> & /*graph*/) override {
+    return router_->route(startId, goalId);
+  }
+
+private:
+  IncrementalRouter *router_;
+};
+
+#endif // INCREMENTAL_STRATEGY_H
@@ -0,0 +1,86 @@
+/**
+ * @file RouteQualityLog.h
+ * @brief Thread-safe record of search effort and route quality.
+ */
+#ifndef ROUTE_QUALITY_LOG_H
+#define ROUTE_QUALITY_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @class RouteQualityLog
+ * @brief Counts nodes settled per search and samples route cost against an
+ * exact search.
+ *
+ * @details
+ * Searches call recordSearch() once per route. Every sampleEvery()-th call
+ * returns true, and the caller then re-solves the query exactly and reports
+ * the two costs with recordSample(). This keeps the cost of measuring small
+ * while still tracking how far a bounded-suboptimal search strays in
+ * practice. Safe to share between the simulation and reroute workers.
+ */
+class RouteQualityLog {
+public:
+  /// @brief Aggregates since construction or the last reset().
+  struct Stats {
+    std::uint64_t searches{0};    ///< Searches recorded.
+    std::uint64_t settled{0};     ///< Nodes settled over those searches.
+    std::uint64_t samples{0};     ///< Searches compared with an exact one.
+    double meanCostRatio{1.0};    ///< Mean route cost / optimal cost.
+    double maxCostRatio{1.0};     ///< Worst route cost / optimal cost.
+    double meanSettledRatio{1.0}; ///< Mean settled / exact search settled.
+
+    /// @return Mean nodes settled per search (0 if none).
+    [[nodiscard]] double settledPerSearch() const {
+      return searches ? static_cast<double>(settled) /
+                            static_cast<double>(searches)
+                      : 0.0;
+    }
+  };
+
+  /// @param sampleEvery Compare every n-th search; 0 never compares.
+  explicit RouteQualityLog(std::size_t sampleEvery = 64)
+      : sampleEvery_(sampleEvery) {}
+
+  RouteQualityLog(const RouteQualityLog &) = delete;
+  RouteQualityLog &operator=(const RouteQualityLog &) = delete;
+
+  /// @brief Change the sampling period (0 disables sampling).
+  void setSampleEvery(std::size_t sampleEvery);
+
+  /**
+   * @brief Record one search that settled @p settled nodes.
+   * @return Whether the caller should compare this route with an exact one.
+   */
+  bool recordSearch(std::size_t settled);
+
+  /**
+   * @brief Record one comparison.
+   * @param cost           Cost of the route that was returned.
+   * @param optimalCost    Cost found by the exact search.
+   * @param settled        Nodes settled by the search being measured.
+   * @param optimalSettled Nodes settled by the exact search.
+   */
+  void recordSample(double cost, double optimalCost, std::size_t settled,
+                    std::size_t optimalSettled);
+
+  /// @return Current aggregates.
+  [[nodiscard]] Stats stats() const;
+
+  /// @brief Clear all aggregates (e.g. after changing the search weight).
+  void reset();
+
+private:
+  mutable std::mutex mutex_;
+  std::size_t sampleEvery_;
+  std::uint64_t searches_{0};
+  std::uint64_t settled_{0};
+  std::uint64_t samples_{0};
+  double costRatioSum_{0.0};
+  double costRatioMax_{1.0};
+  double settledRatioSum_{0.0};
+};
+
+#endif // ROUTE_QUALITY_LOG_H
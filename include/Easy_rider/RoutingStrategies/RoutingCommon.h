@@ -9,17 +9,26 @@
 #include "Easy_rider/TrafficInfrastructure/Intersection.h"
 #include "Easy_rider/TrafficInfrastructure/Road.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
-#include <functional>
+#include <cstddef>
+#include <span>
 #include <vector>
 
 /**
- * @brief External provider of travel time for a directed edge (Road).
+ * @brief Travel time per directed edge, indexed like Graph::getEdges().
  * @details
- * MUST return a finite, non-negative time in the same units across the graph.
+ * Usually a row of EdgeTimeTable. Values MUST be finite, non-negative and in
+ * the same units across the graph.
  */
-using EdgeTimeFn = std::function<double(const Road &)>;
+using EdgeTimes = std::span<const double>;
+
+/// @brief Route of one search and the nodes it settled (its cost).
+struct SearchResult {
+  std::vector<int> route; ///< Node ids start ... goal; empty if none.
+  std::size_t settled{0}; ///< Nodes settled.
+};
 
 /**
  * @brief Rebuild a path of node ids from parent indices.
@@ -57,32 +66,4 @@ rebuildPathIdsFromParents(int startIdx, int goalIdx,
   return ids;
 }
 
-/**
- * @brief Compute an optimistic upper bound on effective speed for A* heuristic.
- * @details
- * The bound is max over edges of (edge.length / timeFn(edge)).
- * Asserts that the result is positive and finite.
- */
-inline double computeVmaxUpperBound(const Graph<Intersection, Road> &graph,
-                                    EdgeTimeFn timeFn) {
-  assert(timeFn && "timeFn must not be null");
-  double vmax = 0.0;
-  for (const auto &e : graph.getEdges()) {
-    const double len = e.getLength();
-    const double t = timeFn(e);
-    assert(std::isfinite(t) && t >= 0.0 &&
-           "timeFn(edge) must be finite and >= 0");
-    if (len > 0.0) {
-      assert(t > 0.0 &&
-             "Positive-length edge must have strictly positive time");
-      const double s = len / t;
-      if (s > vmax)
-        vmax = s;
-    }
-  }
-  assert(vmax > 0.0 &&
-         "No positive effective speed found. Check timeFn and edge lengths.");
-  return vmax;
-}
-
 #endif // ROUTING_COMMON_H
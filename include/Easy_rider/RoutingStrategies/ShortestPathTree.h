@@ -0,0 +1,107 @@
+/**
+ * @file ShortestPathTree.h
+ * @brief One-to-many Dijkstra over per-edge travel times with reusable buffers.
+ */
+#ifndef SHORTEST_PATH_TREE_H
+#define SHORTEST_PATH_TREE_H
+
+#include "RoutingCommon.h"
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ShortestPathTree
+ * @brief Shortest-time tree rooted at one node, grown by Dijkstra.
+ *
+ * @details
+ * A single grow() answers travel times (and paths) from the root to every
+ * settled node, which is what one-to-many queries (OD matrices, batched spawns
+ * sharing an origin) need. Buffers are sized once per graph and only the nodes
+ * touched by the previous search are reset, so repeated grows from different
+ * roots do not pay O(V) initialization each time. growToward() builds the
+ * reverse tree (every node -> root), whose parents are next hops.
+ *
+ * Not thread-safe; use one instance per thread.
+ */
+class ShortestPathTree {
+public:
+  /**
+   * @brief Grow the tree from @p rootIdx.
+   * @param graph   Graph of intersections and roads.
+   * @param weights Travel time per edge index.
+   * @param rootIdx Root node index.
+   * @param stopAt  Node indices of interest; the search stops once all of
+   *                them are settled. Empty means "settle everything reachable".
+   */
+  void grow(const Graph<Intersection, Road> &graph, EdgeTimes weights,
+            int rootIdx, std::span<const int> stopAt = {});
+
+  /**
+   * @brief Grow a reverse tree: shortest paths from every node TO @p rootIdx.
+   *
+   * Afterwards distance(v) is the travel time from v to the root and
+   * parent(v) is the next hop from v towards the root.
+   * @param graph   Graph of intersections and roads.
+   * @param weights Travel time per edge index.
+   * @param rootIdx Destination node index.
+   */
+  void growToward(const Graph<Intersection, Road> &graph, EdgeTimes weights,
+                  int rootIdx);
+
+  /// @return Root node index of the last grow(), or -1 if none.
+  [[nodiscard]] int root() const noexcept { return root_; }
+
+  /// @return Travel time from the root to @p idx (+inf if not reached).
+  [[nodiscard]] double distance(int idx) const {
+    return dist_[static_cast<std::size_t>(idx)];
+  }
+
+  /// @return Predecessor of @p idx on its shortest path (-1 for root/unset).
+  [[nodiscard]] int parent(int idx) const {
+    return parent_[static_cast<std::size_t>(idx)];
+  }
+
+  /// @return Parent array indexed by node index.
+  [[nodiscard]] const std::vector<int> &parents() const noexcept {
+    return parent_;
+  }
+
+  /// @return Node ids root ... goal, or empty if @p goalIdx was not reached.
+  [[nodiscard]] std::vector<int>
+  pathIds(int goalIdx, const Graph<Intersection, Road> &graph) const {
+    return rebuildPathIdsFromParents(root_, goalIdx, parent_, graph);
+  }
+
+  /**
+   * @brief Follow next-hop pointers of a growToward() tree.
+   * @return Node ids start ... root, or empty if @p startIdx cannot reach it.
+   */
+  [[nodiscard]] std::vector<int>
+  pathIdsToRoot(int startIdx, const Graph<Intersection, Road> &graph) const;
+
+private:
+  /// Size buffers for @p n nodes and reset nodes touched by the last search.
+  void reset(std::size_t n);
+
+  /// Dijkstra over outgoing (forward) or incoming (reverse) edges.
+  template <bool Reverse>
+  void search(const Graph<Intersection, Road> &graph, EdgeTimes weights,
+              int rootIdx, std::span<const int> stopAt);
+
+  static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+  int root_{-1};
+  std::vector<double> dist_;
+  std::vector<int> parent_;
+  std::vector<char> settled_;
+  std::vector<std::uint32_t> targetStamp_; ///< == stamp_ if node is in stopAt.
+  std::uint32_t stamp_{0};
+  std::vector<int> touched_; ///< Nodes whose dist_/parent_ were written.
+  std::vector<std::pair<double, int>> heap_; ///< (dist, idx) min-heap storage.
+};
+
+#endif // SHORTEST_PATH_TREE_H
@@ -0,0 +1,121 @@
+/**
+ * @file StrategyTable.h
+ * @brief Routing engines of one vehicle class, shared by all its vehicles.
+ */
+#ifndef STRATEGY_TABLE_H
+#define STRATEGY_TABLE_H
+
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "Easy_rider/Vehicles/Vehicle.h"
+#include "HierarchicalStrategy.h"
+#include "RouteStrategy.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class AdaptiveRouter;
+class AllPairsRouter;
+class DestinationTreeCache;
+class ForecastTable;
+class HubLabelIndex;
+class IncrementalRouter;
+class RouteQualityLog;
+
+/**
+ * @class StrategyTable
+ * @brief One RouteStrategy per StrategyAlgoritm for one vehicle class.
+ *
+ * @details
+ * Engines are composed once per table by composeStrategy():
+ *  - hub labels, when set, answer every algorithm;
+ *  - A* and Dijkstra are priced with the forecast when one is attached, and
+ *    otherwise go through the all-pairs table or destination trees first;
+ *  - Incremental, Hierarchical and Adaptive use their shared routers.
+ *
+ * Vehicles keep a pointer to their class's table and the algorithm they use,
+ * so a fleet holds a few engines in total rather than one per vehicle. The
+ * class's speed cap is the only vehicle parameter the weights depend on, and
+ * it is selected by Sources::classIdx.
+ *
+ * setActive() switches the whole class in O(1) by bumping generation(). Each
+ * vehicle adopts active() the next time it updates. Engines keep no state
+ * between queries, but the table's engines read the simulation's live
+ * snapshot, which changes every tick. Reroute workers therefore compose
+ * their own engine from a copy of sources() whose times and forecast are
+ * immutable copies, through the same composeStrategy().
+ */
+class StrategyTable {
+public:
+  /// @brief Shared state the engines route with (null members are absent).
+  /// The routers and the quality log are synchronised internally.
+  struct Sources {
+    std::shared_ptr<const EdgeTimeTable> times{}; ///< Snapshot (required).
+    std::size_t classIdx{0}; ///< Vehicle class (travel-time row).
+    IncrementalRouter *incremental{};
+    AdaptiveRouter *adaptive{};
+    AllPairsRouter *allPairs{};
+    DestinationTreeCache *cache{};
+    /// Expected loads A* and Dijkstra are priced with.
+    std::shared_ptr<const ForecastTable> forecast{};
+    HierarchyOptions hierarchy{};
+    double astarWeight{1.0};
+    RouteQualityLog *quality{};
+    std::shared_ptr<const HubLabelIndex> hubLabels{};
+  };
+
+  /**
+   * @param sources Shared state; pointees must outlive the table.
+   * @param active  Algorithm the class starts with.
+   */
+  explicit StrategyTable(Sources sources,
+                         StrategyAlgoritm active = StrategyAlgoritm::AStar);
+
+  StrategyTable(const StrategyTable &) = delete;
+  StrategyTable &operator=(const StrategyTable &) = delete;
+
+  /// @brief Recompose every engine from @p sources (e.g. new A* weight).
+  void reset(Sources sources);
+
+  /// @return State the engines were composed from.
+  [[nodiscard]] const Sources &sources() const noexcept { return sources_; }
+
+  /// @return Engine of @p algo.
+  [[nodiscard]] RouteStrategy &get(StrategyAlgoritm algo) const {
+    return *engines_[static_cast<std::size_t>(algo)];
+  }
+
+  /// @brief Switch every vehicle of the class to @p algo (bumps generation).
+  void setActive(StrategyAlgoritm algo) {
+    active_ = algo;
+    ++generation_;
+  }
+
+  /// @return Algorithm set by the last setActive().
+  [[nodiscard]] StrategyAlgoritm active() const noexcept { return active_; }
+
+  /// @return Number of setActive() calls so far.
+  [[nodiscard]] std::uint64_t generation() const noexcept {
+    return generation_;
+  }
+
+private:
+  Sources sources_;
+  std::array<std::unique_ptr<RouteStrategy>, kStrategyAlgoritmCount>
+      engines_{};
+  StrategyAlgoritm active_;
+  std::uint64_t generation_{0};
+};
+
+/**
+ * @brief Engine answering @p algo from @p sources, by the rules listed at
+ * StrategyTable.
+ *
+ * The engine refers to the pointees of @p sources; keep them alive while it
+ * is used. It keeps no state between queries.
+ */
+[[nodiscard]] std::unique_ptr<RouteStrategy>
+composeStrategy(StrategyAlgoritm algo, const StrategyTable::Sources &sources);
+
+#endif // STRATEGY_TABLE_H
@@ -0,0 +1,53 @@
+/**
+ * @file TimeDependentStrategy.h
+ * @brief Dijkstra/A* that prices each edge at the predicted arrival time.
+ */
+#ifndef TIME_DEPENDENT_STRATEGY_H
+#define TIME_DEPENDENT_STRATEGY_H
+
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "Easy_rider/Congestion/LoadForecast.h"
+#include "RouteStrategy.h"
+#include "RoutingCommon.h"
+
+#include <cstddef>
+
+/**
+ * @class TimeDependentStrategy
+ * @brief Label-setting search over arrival times using a load forecast.
+ *
+ * @details
+ * The departure time is forecast.now(). An edge entered at time T costs
+ *   length / min(classCap, speedForLoad(freeSpeed, capacity, load(e, T)))
+ * where load(e, T) comes from the ForecastTable. Beyond the forecast horizon
+ * the current snapshot time is used. With goalDirected set, the search is A*
+ * with h = euclidean / min(classCap, maxFreeSpeed), which stays admissible
+ * whatever the forecast load is. Bucketed loads are not strictly FIFO, so
+ * routes are near-optimal rather than exact.
+ */
+class TimeDependentStrategy final : public RouteStrategy {
+public:
+  /**
+   * @param times        Per-tick edge time snapshot (must outlive this).
+   * @param forecast     Load forecast (must outlive this).
+   * @param classIdx     Vehicle class whose speed cap applies.
+   * @param goalDirected Use an A* heuristic instead of plain Dijkstra.
+   */
+  TimeDependentStrategy(const EdgeTimeTable &times,
+                        const ForecastTable &forecast, std::size_t classIdx,
+                        bool goalDirected)
+      : times_(&times), forecast_(&forecast), classIdx_(classIdx),
+        goalDirected_(goalDirected) {}
+
+  std::vector<int>
+  computeRoute(int startId, int goalId,
+               const Graph<Intersection, Road> &graph) override;
+
+private:
+  const EdgeTimeTable *times_;
+  const ForecastTable *forecast_;
+  std::size_t classIdx_;
+  bool goalDirected_;
+};
+
+#endif // TIME_DEPENDENT_STRATEGY_H
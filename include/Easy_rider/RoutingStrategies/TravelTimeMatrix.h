@@ -0,0 +1,52 @@
+/**
+ * @file TravelTimeMatrix.h
+ * @brief One-to-many / many-to-many travel-time (OD) matrices.
+ */
+#ifndef TRAVEL_TIME_MATRIX_H
+#define TRAVEL_TIME_MATRIX_H
+
+#include "Easy_rider/Concurrency/TaskScheduler.h"
+#include "RoutingCommon.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct TravelTimeMatrix
+ * @brief |S| x |T| travel times between source and target node ids.
+ *
+ * times is row-major: times[i * targets.size() + j] is the shortest travel
+ * time from sources[i] to targets[j]; +inf if unreachable or if either id is
+ * not part of the graph.
+ */
+struct TravelTimeMatrix {
+  std::vector<int> sources; ///< Source node ids (rows).
+  std::vector<int> targets; ///< Target node ids (columns).
+  std::vector<double> times; ///< Row-major travel times.
+
+  /// @return Travel time from sources[i] to targets[j].
+  [[nodiscard]] double at(std::size_t i, std::size_t j) const {
+    return times[i * targets.size() + j];
+  }
+};
+
+/**
+ * @brief Compute travel times from every source to every target.
+ *
+ * Runs one early-terminating one-to-many Dijkstra per distinct source (the
+ * search stops once all targets are settled), distributed over the
+ * scheduler's workers.
+ *
+ * @param graph   Graph of intersections and roads.
+ * @param weights Travel time per edge index (e.g. an EdgeTimeTable row).
+ * @param sources Source node ids.
+ * @param targets Target node ids.
+ * @param scheduler Pool to run the searches on (null runs them inline).
+ */
+[[nodiscard]] TravelTimeMatrix
+computeTravelTimeMatrix(const Graph<Intersection, Road> &graph,
+                        EdgeTimes weights, const std::vector<int> &sources,
+                        const std::vector<int> &targets,
+                        TaskScheduler *scheduler = nullptr);
+
+#endif // TRAVEL_TIME_MATRIX_H
@@ -0,0 +1,79 @@
+/**
+ * @file RerouteScheduler.h
+ * @brief Per-tick budget for reroute work across the whole fleet.
+ */
+#ifndef REROUTE_SCHEDULER_H
+#define REROUTE_SCHEDULER_H
+
+#include "Easy_rider/Vehicles/Vehicle.h"
+#include "Easy_rider/Vehicles/VehicleStore.h"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @class RerouteScheduler
+ * @brief Caps how many reroutes are started per tick and picks which ones.
+ *
+ * Vehicles only flag that they want a new route (congested edge, strategy
+ * switch, ...). Once per tick the scheduler collects those vehicles, orders
+ * them by distance to their next decision node (closest first: their plan
+ * must be ready before they reach that node), and starts reroutes until the
+ * count or time budget is spent. The remaining vehicles keep their flag and
+ * are reconsidered next tick, so a fleet-wide reroute request is spread over
+ * several ticks instead of landing in one.
+ */
+class RerouteScheduler {
+public:
+  /**
+   * @brief Per-tick limits. A zero value disables that limit.
+   */
+  struct Budget {
+    std::size_t maxPerTick{0}; ///< Max reroutes started per tick.
+    double maxMillis{0.0};     ///< Max wall time spent starting reroutes.
+  };
+
+  /// @brief Replace the per-tick budget.
+  void setBudget(const Budget &budget) { budget_ = budget; }
+
+  /// @return Current per-tick budget.
+  [[nodiscard]] const Budget &budget() const noexcept { return budget_; }
+
+  /**
+   * @brief Start reroutes for the most urgent candidates within budget.
+   * @param vehicles Fleet to scan for vehicles that want a reroute.
+   */
+  void run(VehicleStore &vehicles);
+
+  /// @return Reroutes started during the last run().
+  [[nodiscard]] std::size_t lastDispatched() const noexcept {
+    return lastDispatched_;
+  }
+
+  /// @return Reroutes started since construction.
+  [[nodiscard]] std::size_t totalDispatched() const noexcept {
+    return totalDispatched_;
+  }
+
+  /// @return Candidates left waiting by the last run().
+  [[nodiscard]] std::size_t lastDeferred() const noexcept {
+    return lastDeferred_;
+  }
+
+  /// @return Candidate-ticks deferred since construction.
+  [[nodiscard]] std::size_t totalDeferred() const noexcept {
+    return totalDeferred_;
+  }
+
+private:
+  Budget budget_{};
+  std::vector<std::pair<double, Vehicle *>> candidates_; ///< Scratch.
+  std::size_t lastDispatched_{0};
+  std::size_t lastDeferred_{0};
+  std::size_t totalDispatched_{0};
+  std::size_t totalDeferred_{0};
+};
+
+#endif // REROUTE_SCHEDULER_H
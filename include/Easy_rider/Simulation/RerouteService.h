@@ -0,0 +1,97 @@
+/**
+ * @file RerouteService.h
+ * @brief Computes vehicle reroutes off the simulation thread.
+ */
+#ifndef REROUTE_SERVICE_H
+#define REROUTE_SERVICE_H
+
+#include "Easy_rider/Concurrency/TaskScheduler.h"
+#include "Easy_rider/RoutingStrategies/StrategyTable.h"
+#include "Easy_rider/TrafficInfrastructure/Graph.h"
+#include "Easy_rider/TrafficInfrastructure/Intersection.h"
+#include "Easy_rider/TrafficInfrastructure/Road.h"
+#include "Easy_rider/Vehicles/Vehicle.h"
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief A reroute to compute: plan from startId to goalId for one vehicle.
+ *
+ * sources is the vehicle class's StrategyTable::Sources with times and
+ * forecast replaced by immutable copies shared with the simulation, so they
+ * stay valid and unchanged for as long as the request holds them. The
+ * worker composes the engine with composeStrategy(), the same function that
+ * builds the class's StrategyTable.
+ */
+struct RerouteRequest {
+  VehicleHandle vehicle{};
+  int startId{};
+  int goalId{};
+  StrategyAlgoritm algo{StrategyAlgoritm::AStar};
+  StrategyTable::Sources sources{};
+};
+
+/**
+ * @brief A computed reroute (route is empty if no path was found).
+ */
+struct RerouteResult {
+  VehicleHandle vehicle{}; ///< Stale if the vehicle was removed meanwhile.
+  int startId{};
+  std::vector<int> route{};
+};
+
+/**
+ * @class RerouteService
+ * @brief Request queue drained by routing tasks on a TaskScheduler.
+ *
+ * The simulation thread only ever takes short locks: submit() pushes a
+ * request and drainCompleted() swaps out finished results, so a tick never
+ * waits for a route search. At most @c maxTasks searches run at once, which
+ * leaves the other workers to the simulation's parallel phases.
+ */
+class RerouteService {
+public:
+  /**
+   * @param graph     Road network (read-only; must outlive the service).
+   * @param scheduler Pool the searches run on (must outlive the service).
+   * @param maxTasks  Searches running at once (at least one).
+   */
+  RerouteService(const Graph<Intersection, Road> &graph,
+                 TaskScheduler &scheduler, unsigned maxTasks);
+
+  /// @brief Drops queued requests and waits for running searches.
+  ~RerouteService();
+
+  RerouteService(const RerouteService &) = delete;
+  RerouteService &operator=(const RerouteService &) = delete;
+
+  /// @brief Queue a request for the workers.
+  void submit(RerouteRequest request);
+
+  /// @brief Move all finished results into @p out (appends; non-blocking).
+  void drainCompleted(std::vector<RerouteResult> &out);
+
+  /// @return Requests queued or being computed.
+  [[nodiscard]] std::size_t inFlight() const;
+
+private:
+  // Body of one routing task: serve requests until the queue is empty.
+  void drainQueue();
+
+  const Graph<Intersection, Road> &graph_;
+  unsigned maxTasks_;
+
+  mutable std::mutex mutex_;
+  std::deque<RerouteRequest> queue_;
+  std::vector<RerouteResult> done_;
+  std::size_t inFlight_{0};
+  unsigned running_{0}; ///< Routing tasks started and not yet finished.
+  bool stopping_{false};
+
+  TaskGroup tasks_; ///< Last member: waited for first.
+};
+
+#endif // REROUTE_SERVICE_H
@@ -1,17 +1,35 @@
 #ifndef SIMULATION_H
 #define SIMULATION_H
 
+#include "Easy_rider/Concurrency/TaskScheduler.h"
 #include "Easy_rider/Congestion/CongestionModel.h"
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "Easy_rider/Congestion/LoadForecast.h"
 #include "Easy_rider/Parameters/Parameters.h"
+#include "Easy_rider/RoutingStrategies/AdaptiveRouter.h"
+#include "Easy_rider/RoutingStrategies/AllPairsRouter.h"
+#include "Easy_rider/RoutingStrategies/DestinationTreeCache.h"
+#include "Easy_rider/RoutingStrategies/HubLabels.h"
+#include "Easy_rider/RoutingStrategies/IncrementalRouter.h"
+#include "Easy_rider/RoutingStrategies/RouteQualityLog.h"
 #include "Easy_rider/RoutingStrategies/RouteStrategy.h"
+#include "Easy_rider/RoutingStrategies/ShortestPathTree.h"
+#include "Easy_rider/RoutingStrategies/StrategyTable.h"
+#include "Easy_rider/RoutingStrategies/TravelTimeMatrix.h"
+#include "Easy_rider/Simulation/RerouteScheduler.h"
+#include "Easy_rider/Simulation/RerouteService.h"
 #include "Easy_rider/TrafficInfrastructure/Graph.h"
 #include "Easy_rider/TrafficInfrastructure/Intersection.h"
 #include "Easy_rider/TrafficInfrastructure/Road.h"
+#include "Easy_rider/Vehicles/EdgeLanes.h"
 #include "Easy_rider/Vehicles/Vehicle.h"
+#include "Easy_rider/Vehicles/VehicleStore.h"
 
+#include <array>
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -23,14 +41,11 @@ class Simulation {
 public:
   struct Stats {
     std::size_t vehicles{}; ///< Number of vehicles currently tracked.
+    std::size_t recycled{}; ///< Vehicles built on pooled storage so far.
   };
 
   /// @brief Build a simulation with an existing graph snapshot.
-  explicit Simulation(Graph<Intersection, Road> graph)
-      : graph_(std::move(graph)) {
-    lastStrategy_ = Parameters::isDijkstra() ? StrategyAlgoritm::Dijkstra
-                                             : StrategyAlgoritm::AStar;
-  }
+  explicit Simulation(Graph<Intersection, Road> graph);
 
   ~Simulation();
 
@@ -46,19 +61,85 @@ public:
   /// @brief Stop advancing time (state preserved; call start() to resume).
   void stop() { running_ = false; }
 
-  /// @brief Advance the simulation by dt seconds (scaled internally if needed).
+  /// @brief Advance the simulation by one step of @p dt simulated seconds.
   void update(double dt);
 
+  /**
+   * @brief Advance by @p seconds of real time in fixed steps.
+   *
+   * The time, scaled by Parameters::simulationSpeed(), is added to an
+   * accumulator that is drained in steps of Parameters::physicsDt(), so a
+   * time warp runs more steps instead of longer ones. At most
+   * Parameters::maxSubsteps() steps run per call; time beyond that (a
+   * frame hitch, or a warp the machine cannot keep up with) is dropped.
+   * The remainder is kept for the next call and sets
+   * interpolationAlpha().
+   * @return Steps taken.
+   */
+  std::size_t advanceFrame(double seconds);
+
+  /// @return Fraction of a step accumulated since the last one, in [0, 1).
+  [[nodiscard]] double interpolationAlpha() const noexcept { return alpha_; }
+
   /// @brief Create and add a new car; returns its vehicle id.
   int spawnVehicleCar(int startId, int goalId, StrategyAlgoritm algo);
 
   /// @brief Create and add a new truck; returns its vehicle id.
   int spawnVehicleTruck(int startId, int goalId, StrategyAlgoritm algo);
 
-  /// @brief Replace routing strategy for all vehicles (future (re)routes).
+  /// @brief One vehicle to create in a batch spawn.
+  struct SpawnRequest {
+    int startId{};                      ///< Origin node id.
+    int goalId{};                       ///< Destination node id.
+    VehicleClass cls{VehicleClass::Car}; ///< Vehicle class to create.
+  };
+
+  /**
+   * @brief Create many vehicles at once; returns their ids in request order.
+   *
+   * Routes are those @p algo gives on the class's StrategyTable. For exact
+   * A* and Dijkstra without hub labels, requests sharing an origin and class
+   * are served by one one-to-many search (stopping once all their goals are
+   * settled); other engines answer each request. Distinct groups are routed
+   * on the scheduler. All vehicles are inserted afterwards on the calling
+   * thread. With a load forecast, each vehicle is instead routed as it is
+   * inserted, so its route sees the load of those before it.
+   * @param requests (start, goal, class) tuples.
+   * @param algo     Strategy of the new vehicles' initial routes and later
+   *                 reroutes.
+   */
+  std::vector<int> spawnVehicles(const std::vector<SpawnRequest> &requests,
+                                 StrategyAlgoritm algo);
+
+  /**
+   * @brief Replace routing strategy for all vehicles (future (re)routes).
+   *
+   * O(1) per vehicle class: vehicles share their class's StrategyTable and
+   * pick the new algorithm up on their next update.
+   */
   void setStrategyForAll(StrategyAlgoritm algo);
 
-  [[nodiscard]] Stats stats() const { return Stats{vehicles_.size()}; }
+  /// @return Strategy currently selected in Parameters.
+  [[nodiscard]] static StrategyAlgoritm configuredStrategy();
+
+  /**
+   * @brief Travel times between node sets under the current congestion state.
+   * @param sources Source node ids (rows).
+   * @param targets Target node ids (columns).
+   * @param cls     Vehicle class whose speed cap applies.
+   */
+  [[nodiscard]] TravelTimeMatrix
+  travelTimeMatrix(const std::vector<int> &sources,
+                   const std::vector<int> &targets,
+                   VehicleClass cls = VehicleClass::Car) const;
+
+  [[nodiscard]] Stats stats() const {
+    return Stats{vehicles_.size(), vehicles_.recycled()};
+  }
+
+  /// @brief Thread pool shared by the update, routing and generators
+  /// (sized by Parameters::simulationThreads()).
+  [[nodiscard]] TaskScheduler &scheduler() { return scheduler_; }
 
   /// @brief Lightweight snapshot of in-flight vehicles for UI/telemetry.
   struct SimSnapshotItem {
@@ -72,6 +153,13 @@ public:
   /// @return Vector of per-vehicle snapshot items.
   [[nodiscard]] std::vector<SimSnapshotItem> snapshot() const;
 
+  /**
+   * @return snapshot() blended between the states before and after the last
+   * step of advanceFrame() by interpolationAlpha(). Vehicles that changed
+   * edge (or appeared) in that step are shown at their current state.
+   */
+  [[nodiscard]] std::vector<SimSnapshotItem> interpolatedSnapshot() const;
+
   [[nodiscard]] const Graph<Intersection, Road> &graph() const {
     return graph_;
   }
@@ -82,18 +170,26 @@ public:
   }
   [[nodiscard]] CongestionModel &congestion() { return congestion_; }
 
+  /// @brief Edge speed/travel-time snapshot taken at the start of the tick.
+  [[nodiscard]] const EdgeTimeTable &edgeTimes() const { return edgeTimes_; }
+
   [[nodiscard]] double getSimTime() const noexcept;
   [[nodiscard]] double averageSpeed() const noexcept;
 
-  [[nodiscard]] const std::vector<std::unique_ptr<Vehicle>> &vehicles() const {
-    return vehicles_;
-  }
+  /// @brief Every vehicle; slots change when vehicles are pruned.
+  [[nodiscard]] const VehicleStore &vehicles() const { return vehicles_; }
+
+  /// @brief Vehicles queued on each edge, in driving order.
+  [[nodiscard]] const EdgeLanes &lanes() const { return vehicles_.lanes(); }
 
   /// @brief Register a callback invoked after each successful update(dt).
   void setOnPostUpdate(std::function<void(double)> cb) {
     onPostUpdate_ = std::move(cb);
   }
 
+  /// @return Vehicles created so far (each was given an initial route).
+  [[nodiscard]] std::size_t spawnCount() const noexcept { return spawnCount_; }
+
   /// @return Number of re-routes performed so far.
   [[nodiscard]] std::size_t rerouteCount() const noexcept {
     return rerouteCount_;
@@ -104,29 +200,172 @@ public:
     return rerouteSavedTime_;
   }
 
+  /// @return Reroute candidates left waiting by the last tick's budget.
+  [[nodiscard]] std::size_t rerouteDeferred() const noexcept {
+    return rerouteScheduler_.lastDeferred();
+  }
+
+  /// @brief Per-tick reroute budget (defaults come from Parameters).
+  [[nodiscard]] RerouteScheduler &rerouteScheduler() noexcept {
+    return rerouteScheduler_;
+  }
+
+  /// @brief Shared incremental router of one vehicle class.
+  [[nodiscard]] const IncrementalRouter &
+  incrementalRouter(VehicleClass cls) const {
+    return *incrementalRouters_[static_cast<std::size_t>(cls)];
+  }
+
+  /// @brief All-pairs table of one vehicle class (null unless the network is
+  /// small enough, see Parameters::allPairsMaxNodes()).
+  [[nodiscard]] const AllPairsRouter *allPairsRouter(VehicleClass cls) const {
+    return allPairsRouters_[static_cast<std::size_t>(cls)].get();
+  }
+
+  /// @brief Engine selector of one vehicle class; histogram() tells which
+  /// engines StrategyAlgoritm::Adaptive queries ended up using.
+  [[nodiscard]] const AdaptiveRouter &adaptiveRouter(VehicleClass cls) const {
+    return *adaptiveRouters_[static_cast<std::size_t>(cls)];
+  }
+
+  /// @brief Shared next-hop trees of one vehicle class (null if disabled).
+  [[nodiscard]] const DestinationTreeCache *
+  destinationCache(VehicleClass cls) const {
+    return destinationCaches_[static_cast<std::size_t>(cls)].get();
+  }
+
+  /**
+   * @brief Route every vehicle of @p cls (current and future) with @p labels,
+   * or restore the configured strategies if @p labels is null.
+   */
+  void setHubLabels(VehicleClass cls,
+                    std::shared_ptr<const HubLabelIndex> labels);
+
+  /**
+   * @brief Map the hub labels at @p path, or build them from free-flow times
+   * of @p cls (and write them to @p path) if the file is missing, corrupt,
+   * or was built for another network or another class's weights.
+   * @return The labels, which are also set for @p cls; stats() reports label
+   * sizes and build time.
+   */
+  std::shared_ptr<const HubLabelIndex> loadOrBuildHubLabels(
+      VehicleClass cls, const std::string &path);
+
+  /// @brief Hub labels of one vehicle class (null if not set).
+  [[nodiscard]] const std::shared_ptr<const HubLabelIndex> &
+  hubLabels(VehicleClass cls) const {
+    return hubLabels_[static_cast<std::size_t>(cls)];
+  }
+
+  /// @brief Forecast edge loads (null unless time-dependent routing is on).
+  [[nodiscard]] const LoadForecast *loadForecast() const {
+    return forecast_.get();
+  }
+
+  /**
+   * @brief Search effort and route quality of A* routes since the weight
+   * (Parameters::astarWeight()) last changed. Routes answered by the
+   * all-pairs table or a destination cache are not searched or recorded.
+   */
+  [[nodiscard]] const RouteQualityLog &routeQuality() const {
+    return routeQuality_;
+  }
+
+  /// @return Asynchronous reroutes queued or being computed.
+  [[nodiscard]] std::size_t reroutesInFlight() const {
+    return rerouter_ ? rerouter_->inFlight() : 0;
+  }
+
 private:
+  // Shared state the class's StrategyTable composes its engines from.
+  [[nodiscard]] StrategyTable::Sources strategySources(std::size_t cls);
+
+  // Add a vehicle of @p cls and wire strategy/telemetry; returns its slot.
+  std::size_t adoptVehicle(VehicleClass cls, StrategyAlgoritm algo);
+
+  // Queue an asynchronous reroute against a shared weight snapshot.
+  void requestReroute(Vehicle &veh, int startId, int goalId);
+
+  // Apply reroutes finished by the workers since the last tick.
+  void applyCompletedReroutes();
+
   // Ensure a route exists for a newly spawned vehicle.
-  void ensureInitialRoutes(int vehIdx, int startId, int goalId);
+  void ensureInitialRoutes(std::size_t slot, int startId, int goalId);
 
-  // Remove arrived vehicles and free resources.
+  // Remove the vehicles that arrived during this tick.
   void pruneArrivedVehicles();
 
-  Graph<Intersection, Road> graph_;                ///< Road network.
-  CongestionModel congestion_;                     ///< Congestion model.
-  std::vector<std::unique_ptr<Vehicle>> vehicles_; ///< Owned vehicles.
+  mutable TaskScheduler scheduler_;          ///< First: outlives its users.
+  Graph<Intersection, Road> graph_;          ///< Road network.
+  CongestionModel congestion_;               ///< Congestion model.
+  EdgeTimeTable edgeTimes_;                  ///< Per-tick snapshot.
+  std::unique_ptr<LoadForecast> forecast_{}; ///< Outlives vehicles_.
+  VehicleStore vehicles_;                    ///< Owned vehicles.
 
   bool running_{false};
   bool paused_{false};
   double simTime_{0.0};
 
+  // Fixed-step state of advanceFrame().
+  double accumulator_{0.0};                   ///< Unsimulated seconds.
+  double alpha_{0.0};                         ///< accumulator_ / step.
+  std::vector<SimSnapshotItem> prevFrame_{}; ///< Before last step, by id.
+
   std::function<void(double)> onPostUpdate_{};
 
   // Re-routing telemetry.
+  std::size_t spawnCount_{0};
   std::size_t rerouteCount_{0};
   double rerouteSavedTime_{0.0};
 
   // Last chosen strategy (used for subsequent spawns if desired).
   StrategyAlgoritm lastStrategy_{StrategyAlgoritm::AStar};
+  double astarWeight_{Parameters::astarWeight()}; ///< Weight vehicles use.
+
+  /// A* settled nodes and cost ratio against Dijkstra, for the current weight.
+  RouteQualityLog routeQuality_{Parameters::routeQualitySampleEvery()};
+
+  RerouteScheduler rerouteScheduler_{}; ///< Caps reroute work per tick.
+
+  /// Per-class goal trees shared by StrategyAlgoritm::Incremental vehicles.
+  std::array<std::unique_ptr<IncrementalRouter>, kVehicleClassCount>
+      incrementalRouters_{};
+
+  /// Per-class reverse trees of popular goals (null when disabled).
+  std::array<std::unique_ptr<DestinationTreeCache>, kVehicleClassCount>
+      destinationCaches_{};
+
+  /// Per-class all-pairs tables on small networks (null otherwise).
+  std::array<std::unique_ptr<AllPairsRouter>, kVehicleClassCount>
+      allPairsRouters_{};
+
+  /// Per-class engine selectors of StrategyAlgoritm::Adaptive vehicles; they
+  /// point at the tables and caches above, so are declared after them.
+  std::array<std::unique_ptr<AdaptiveRouter>, kVehicleClassCount>
+      adaptiveRouters_{};
+
+  /// Per-class fixed-weight labels (null unless setHubLabels() was called).
+  std::array<std::shared_ptr<const HubLabelIndex>, kVehicleClassCount>
+      hubLabels_{};
+
+  /// Per-class routing engines shared by the class's vehicles; declared
+  /// after every router they point at.
+  std::array<std::unique_ptr<StrategyTable>, kVehicleClassCount>
+      strategyTables_{};
+
+  // Callbacks shared by every vehicle (see adoptVehicle()).
+  Vehicle::RerouteApplied onRerouteApplied_{};
+  Vehicle::RerouteRequester rerouteRequester_{};
+
+  // Forecast copy handed to workers, refreshed at most once per tick.
+  std::shared_ptr<const ForecastTable> sharedForecast_{};
+  double sharedForecastAt_{-1.0};
+
+  // Asynchronous rerouting (null when Parameters::asyncRerouting() is off).
+  std::shared_ptr<const EdgeTimeTable> sharedTimes_{}; ///< Handed to workers.
+  std::vector<RerouteResult> rerouteResults_{};        ///< Drain scratch.
+  PerWorker<ShortestPathTree> spawnTrees_{}; ///< spawnVehicles() scratch.
+  std::unique_ptr<RerouteService> rerouter_{}; ///< Destroyed first.
 };
 
 #endif // SIMULATION_H
@@ -85,7 +85,7 @@ public:
                         int targetCars, int targetTrucks,
                         uint32_t seed = std::random_device{}());
 
-  /// @brief Spawn up to target levels once.
+  /// @brief Spawn up to target levels once (as a single batch).
   void seedInitial();
 
   /// @brief Ensure current counts stay at or near targets (top-up only).
@@ -105,8 +105,9 @@ private:
   /// @return Distinct (start, goal) node ids.
   [[nodiscard]] std::pair<int, int> randomDistinctPair();
 
-  void spawnOneCar();
-  void spawnOneTruck();
+  /// @brief Append @p count random (start, goal) requests of class @p cls.
+  void appendRandomRequests(std::vector<Simulation::SpawnRequest> &batch,
+                            VehicleClass cls, int count);
 };
 
 } // namespace SimulationUtils
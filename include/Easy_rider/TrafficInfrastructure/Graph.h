@@ -16,8 +16,8 @@
  * via T::getId().
  *  - Edges are directed (fromId -> toId) and stored contiguously
  * (std::vector<U>).
- *  - Outgoing adjacency (unordered_map<int, vector<int>>) is updated on every
- * edge insertion.
+ *  - Outgoing and incoming adjacency (one vector per node index each) are
+ * updated on every edge insertion.
  *  - Geometry helpers are provided internally to reject duplicate edges and
  * planar crossings in addEdgeIfNotExists().
  */
@@ -28,6 +28,7 @@
 #include <concepts>
 #include <cstddef>
 #include <functional>
+#include <optional>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -90,6 +91,8 @@ public:
     const int id = node.getId();
     nodeIndexById_[id] = nodes_.size();
     nodes_.push_back(node);
+    outgoingIndex_.emplace_back();
+    incomingIndex_.emplace_back();
   }
 
   /**
@@ -105,7 +108,8 @@ public:
     const int vIdx = static_cast<int>(indexOfId(vId));
 
     const std::size_t eIdx = edges_.size() - 1;
-    outgoingIndex_[uIdx].emplace_back(vIdx, eIdx);
+    outgoingIndex_[static_cast<std::size_t>(uIdx)].emplace_back(vIdx, eIdx);
+    incomingIndex_[static_cast<std::size_t>(vIdx)].emplace_back(uIdx, eIdx);
   }
 
   /**
@@ -194,11 +198,7 @@ public:
 
   std::vector<NeighborEdge> outgoing(int uIdx) const {
     std::vector<NeighborEdge> result;
-    auto it = outgoingIndex_.find(uIdx);
-    if (it == outgoingIndex_.end())
-      return result;
-
-    const auto &lst = it->second;
+    const auto &lst = outgoingIndices(uIdx);
     result.reserve(lst.size());
     for (const auto &p : lst) {
       const int vIdx = p.first;
@@ -208,6 +208,57 @@ public:
     return result;
   }
 
+  /**
+   * @brief Outgoing adjacency by node index, without copying.
+   * @param uIdx Source node index.
+   * @return const reference to (neighbor node index, edge index) pairs. Empty
+   * if none.
+   *
+   * Hot-path variant of outgoing() for search loops that index per-edge
+   * arrays parallel to getEdges().
+   */
+  const std::vector<std::pair<int, std::size_t>> &
+  outgoingIndices(int uIdx) const {
+    static const std::vector<std::pair<int, std::size_t>> kEmpty;
+    if (uIdx < 0 || static_cast<std::size_t>(uIdx) >= outgoingIndex_.size())
+      return kEmpty;
+    return outgoingIndex_[static_cast<std::size_t>(uIdx)];
+  }
+
+  /**
+   * @brief Incoming adjacency by node index, without copying.
+   * @param vIdx Target node index.
+   * @return const reference to (predecessor node index, edge index) pairs.
+   * Empty if none.
+   *
+   * Used by searches that run backwards from a goal.
+   */
+  const std::vector<std::pair<int, std::size_t>> &
+  incomingIndices(int vIdx) const {
+    static const std::vector<std::pair<int, std::size_t>> kEmpty;
+    if (vIdx < 0 || static_cast<std::size_t>(vIdx) >= incomingIndex_.size())
+      return kEmpty;
+    return incomingIndex_[static_cast<std::size_t>(vIdx)];
+  }
+
+  /**
+   * @brief Index of the directed edge fromId -> toId in getEdges().
+   * @return Edge index, or std::nullopt if either node or the edge is missing.
+   */
+  std::optional<std::size_t> edgeIndexOf(int fromId, int toId) const {
+    const auto from = nodeIndexById_.find(fromId);
+    const auto to = nodeIndexById_.find(toId);
+    if (from == nodeIndexById_.end() || to == nodeIndexById_.end())
+      return std::nullopt;
+    const int vIdx = static_cast<int>(to->second);
+    for (const auto &[nbr, eIdx] :
+         outgoingIndices(static_cast<int>(from->second))) {
+      if (nbr == vIdx)
+        return eIdx;
+    }
+    return std::nullopt;
+  }
+
   /**
    * @brief Accessor for the id→index map (read-only).
    */
@@ -220,8 +271,10 @@ private:
   std::vector<U> edges_; /**< Stored edges. */
 
   std::unordered_map<int, std::size_t> nodeIndexById_; /**< Fast id->index. */
-  std::unordered_map<int, std::vector<std::pair<int, std::size_t>>>
-      outgoingIndex_;
+  std::vector<std::vector<std::pair<int, std::size_t>>>
+      outgoingIndex_; /**< Per node index: (neighbor index, edge index). */
+  std::vector<std::vector<std::pair<int, std::size_t>>>
+      incomingIndex_; /**< Per node index: (predecessor index, edge index). */
 
   /**
    * @brief  Compute the 2D orientation (cross product) of the triplet (A, B,
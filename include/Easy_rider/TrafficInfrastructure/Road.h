@@ -8,8 +8,17 @@
 
 #include "Intersection.h"
 
+#include <cstdint>
 #include <utility>
 
+/**
+ * @brief Functional class of a road, from the top of the hierarchy down.
+ *
+ * Set by the generator that built the road: motorway corridors, the highway
+ * spanning tree, and the local street mesh.
+ */
+enum class RoadClass : std::uint8_t { Motorway, Highway, Street };
+
 /**
  * @class Road
  * @brief Represents a directed road connecting two intersections (by ids), with
@@ -39,9 +48,10 @@ public:
    * @param maxSpeed           Maximum allowed speed on this road.
    * @param capacityVehicles   Capacity "x" (current vehicles allowed before
    * halving tiers).
+   * @param roadClass          Place in the road hierarchy.
    */
   Road(const Intersection &from, const Intersection &to, int maxSpeed,
-       int capacityVehicles);
+       int capacityVehicles, RoadClass roadClass = RoadClass::Street);
 
   /// @return Source node id.
   int getFromId() const;
@@ -58,12 +68,16 @@ public:
   /// @return Capacity (vehicles) reported by this road.
   int getCapacityVehicles() const;
 
+  /// @return Place in the road hierarchy.
+  RoadClass getRoadClass() const;
+
 private:
   int fromId_;           /**< Source node id. */
   int toId_;             /**< Target node id. */
   double length_;        /**< Cached Euclidean distance between endpoints. */
   int maxSpeed_;         /**< Maximum allowed speed along this road. */
   int capacityVehicles_; /**< Capacity "x" (vehicles concurrently on edge). */
+  RoadClass roadClass_;  /**< Place in the road hierarchy. */
 
   inline static constexpr int kDefaultCapacityVehicles = 10;
   /// @brief Helper to compute distance from two positions.
@@ -4,15 +4,18 @@
 #include "Vehicle.h"
 
 /**
- * @class Car
+ * @struct Car
  * @brief Passenger car - nimble, higher acceleration.
+ *
+ * A parameter set: vehicles of this class share these IDM parameters through
+ * VehicleStore instead of being a Vehicle subclass.
  */
-class Car final : public Vehicle {
-public:
-  Car(const Graph<Intersection, Road> &graph, CongestionModel *congestion)
-      : Vehicle(graph, congestion,
-                IDMParams{/*a*/ 35.0, /*b*/ 40.0, /*v0*/ 50.0,
-                          /*T*/ 1.2, /*s0*/ 2.0, /*delta*/ 4.0}) {}
+struct Car {
+  static constexpr VehicleClass kClass = VehicleClass::Car;
+
+  /// IDM parameters shared by every car.
+  static constexpr IDMParams kIDMParams{/*a*/ 35.0, /*b*/ 40.0, /*v0*/ 50.0,
+                                        /*T*/ 1.2, /*s0*/ 2.0, /*delta*/ 4.0};
 };
 
 #endif // CAR_H
@@ -0,0 +1,84 @@
+/**
+ * @file EdgeLanes.h
+ * @brief Persistent per-edge queues of the vehicles driving on each edge.
+ */
+#ifndef EDGE_LANES_H
+#define EDGE_LANES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @class EdgeLanes
+ * @brief One FIFO queue per edge, linked through per-slot arrays.
+ *
+ * @details
+ * Vehicles on an edge never overtake, so their order only changes when one
+ * enters (at the back) or leaves. Vehicle::enterEdge() and
+ * Vehicle::leaveEdge() keep the queues current. Each vehicle then knows its
+ * leader (leader()) without any per-tick sorting or allocation.
+ * Vehicles are named by their VehicleStore slot. The links are two arrays
+ * indexed by slot, so enter and leave are O(1), even for a vehicle that
+ * leaves from the middle of a queue.
+ */
+class EdgeLanes {
+public:
+  /// Slot value meaning "no vehicle".
+  static constexpr std::uint32_t kNone =
+      std::numeric_limits<std::uint32_t>::max();
+
+  /// @brief Append a new, unqueued slot at the end of the slot range.
+  void addSlot() {
+    ahead_.push_back(kNone);
+    behind_.push_back(kNone);
+  }
+
+  /// @brief Drop the last slot (must not be queued).
+  void popSlot() {
+    ahead_.pop_back();
+    behind_.pop_back();
+  }
+
+  /// @brief Append @p slot at the entrance of edge @p edgeIdx.
+  void enter(std::size_t edgeIdx, std::uint32_t slot);
+
+  /// @brief Unlink @p slot from edge @p edgeIdx (no-op if not queued there).
+  void leave(std::size_t edgeIdx, std::uint32_t slot);
+
+  /**
+   * @brief The vehicle in slot @p from now lives in slot @p to.
+   * @param edgeIdx Edge the vehicle is queued on, or any value past the
+   *                edge range if it is not queued.
+   */
+  void relocate(std::size_t edgeIdx, std::uint32_t from, std::uint32_t to);
+
+  /// @return Slot of the vehicle ahead of @p slot on its edge, or kNone.
+  [[nodiscard]] std::uint32_t leader(std::size_t slot) const {
+    return ahead_[slot];
+  }
+
+  /// @return Slot closest to the end of edge @p edgeIdx, or kNone.
+  [[nodiscard]] std::uint32_t front(std::size_t edgeIdx) const {
+    return edgeIdx < lanes_.size() ? lanes_[edgeIdx].front : kNone;
+  }
+
+  /// @return Vehicles queued on edge @p edgeIdx.
+  [[nodiscard]] std::size_t count(std::size_t edgeIdx) const {
+    return edgeIdx < lanes_.size() ? lanes_[edgeIdx].count : 0;
+  }
+
+private:
+  struct Lane {
+    std::uint32_t front{kNone}; ///< Furthest along; leaves first.
+    std::uint32_t back{kNone};  ///< Last to enter.
+    std::size_t count{0};
+  };
+
+  std::vector<Lane> lanes_;           ///< By edge index; grows on demand.
+  std::vector<std::uint32_t> ahead_;  ///< By slot: next toward the edge end.
+  std::vector<std::uint32_t> behind_; ///< By slot: next toward the start.
+};
+
+#endif // EDGE_LANES_H
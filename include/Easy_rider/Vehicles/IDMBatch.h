@@ -0,0 +1,30 @@
+/**
+ * @file IDMBatch.h
+ * @brief IDM acceleration for many vehicles sharing one parameter set.
+ */
+#ifndef IDM_BATCH_H
+#define IDM_BATCH_H
+
+#include "IDM.h"
+
+#include <cstddef>
+
+/**
+ * @brief out[i] = idm_accel(v[i], v0[i], gap[i], dv[i], p) for i < n.
+ *
+ * Integer exponents 1 to 4 (the usual delta is 4) use idm_accel_int(), so
+ * no std::pow is called. Other exponents fall back to idm_accel(). When the
+ * library is built with AVX2 (EASY_RIDER_AVX2), the integer cases run four
+ * vehicles per instruction and the remainder runs scalar. Either way, the
+ * results match idm_accel() to a few ulp.
+ *
+ * The arrays must not overlap @p out.
+ */
+void idm_accel_batch(const IDMParams &p, std::size_t n, const double *v,
+                     const double *v0, const double *gap, const double *dv,
+                     double *out);
+
+/// @return Whether idm_accel_batch() was compiled with the AVX2 path.
+[[nodiscard]] bool idm_batch_uses_avx2() noexcept;
+
+#endif // IDM_BATCH_H
@@ -0,0 +1,141 @@
+/**
+ * @file MesoscopicModel.h
+ * @brief Event-driven queue model of the fleet: vehicles jump from edge to
+ * edge at their exit times instead of being integrated every tick.
+ */
+#ifndef MESOSCOPIC_MODEL_H
+#define MESOSCOPIC_MODEL_H
+
+#include "Vehicle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+class VehicleStore;
+
+/// @brief Tuning of the MesoscopicModel.
+struct MesoscopicOptions {
+  /// Vehicles an edge holds, as a multiple of Road::getCapacityVehicles().
+  double storageFactor{4.0};
+  /// Minimum seconds between two vehicles leaving the same edge.
+  double exitHeadway{1.0};
+  /// Seconds a vehicle waits for room on a full edge before entering anyway
+  /// (breaks gridlock).
+  double stuckTime{10.0};
+};
+
+/**
+ * @class MesoscopicModel
+ * @brief Every edge is a FIFO queue; a global event queue holds the time at
+ * which each vehicle is due to leave its edge.
+ *
+ * @details
+ * On entering an edge a vehicle is given the travel time
+ * length / min(v0, effective speed), the same rule as
+ * CongestionModel::edgeTime() at the speed of the tick's EdgeTimeTable, and
+ * an exit event at that time. Load beyond the storage capacity waits at the
+ * entrance rather than slowing the edge further, so the speed is never
+ * taken below the halving tier of a full edge: a vehicle keeps its travel
+ * time once it has entered, and a near-zero speed would hold it long after
+ * the jam cleared. advance() pops the events that fall within the
+ * step, in time order, and moves each vehicle on with Vehicle::finishEdge(),
+ * so routes, reroutes, arrivals, lanes and congestion counts behave as in the
+ * microscopic model. A vehicle only leaves after the one ahead of it (plus
+ * the exit headway), and only enters an edge holding fewer than its storage
+ * capacity; otherwise it waits at the end of its edge and is woken when room
+ * appears, or after the stuck time.
+ *
+ * A step costs O(events * log(vehicles)), independent of the fleet size,
+ * and may be as long as the application likes: events are processed at
+ * their own time, not at the end of the step.
+ *
+ * Timing state is indexed by VehicleHandle::index, so it does not move when
+ * the store swaps slots; events of removed vehicles, or of vehicles that
+ * changed edge meanwhile, are recognised as stale and dropped when popped.
+ * Owned by a VehicleStore (see VehicleStore::setMesoscopic()).
+ */
+class MesoscopicModel {
+public:
+  void setOptions(const MesoscopicOptions &options) { options_ = options; }
+  [[nodiscard]] const MesoscopicOptions &options() const noexcept {
+    return options_;
+  }
+
+  /// @brief Schedule every vehicle already on an edge, continuing from its
+  /// current position.
+  void enable(VehicleStore &store);
+
+  /// @brief Write positions back to the store for the microscopic model and
+  /// drop all events.
+  void disable(VehicleStore &store);
+
+  /// @brief The vehicle in @p slot has just entered its current edge, at
+  /// speed @p speed.
+  void onEnter(VehicleStore &store, std::size_t slot, double speed);
+
+  /// @brief A vehicle has just left edge @p edgeIdx: release its new front
+  /// and the first vehicle waiting for room on it.
+  void onLeave(VehicleStore &store, std::size_t edgeIdx);
+
+  /// @brief Process every exit due within the next @p dt seconds.
+  void advance(VehicleStore &store, double dt);
+
+  /// @return Position along its edge of the vehicle in @p slot, interpolated
+  /// between its entry and exit times.
+  [[nodiscard]] double progress(const VehicleStore &store,
+                                std::size_t slot) const;
+
+  /// @return Exit events queued, stale ones included.
+  [[nodiscard]] std::size_t pendingEvents() const noexcept {
+    return events_.size();
+  }
+
+private:
+  static constexpr double kNever = std::numeric_limits<double>::infinity();
+
+  struct Event {
+    double time{};
+    VehicleHandle vehicle{};
+
+    // Later first for std::priority_queue; ties by handle for determinism.
+    bool operator>(const Event &o) const {
+      return time != o.time ? time > o.time
+                            : vehicle.index > o.vehicle.index;
+    }
+  };
+
+  struct Timing {
+    double enteredAt{0.0};
+    double exitAt{0.0};        ///< Free-flow exit time.
+    double eventAt{kNever};    ///< Time of the live event; kNever if parked.
+    double waitingSince{-1.0}; ///< Start of the wait for room; -1 if none.
+  };
+
+  [[nodiscard]] Timing &timing(const VehicleStore &store, std::size_t slot);
+
+  // Road capacity of edge @p edgeIdx (at least 1).
+  [[nodiscard]] static int capacity(const Vehicle &v, std::size_t edgeIdx);
+
+  // @p speed, raised to the speed of edge @p edgeIdx when full.
+  [[nodiscard]] double crossingSpeed(const VehicleStore &store,
+                                     std::size_t slot, std::size_t edgeIdx,
+                                     double speed) const;
+
+  void schedule(const VehicleStore &store, std::size_t slot, double time);
+
+  // Move the vehicle in @p slot on, or park it until it can move.
+  void tryExit(VehicleStore &store, std::size_t slot);
+
+  MesoscopicOptions options_{};
+  std::vector<Timing> timing_;       ///< By VehicleHandle::index.
+  std::vector<double> edgeLastExit_; ///< By edge: time of the last exit.
+  std::vector<std::deque<VehicleHandle>> waiters_; ///< By full edge.
+  std::priority_queue<Event, std::vector<Event>, std::greater<>> events_;
+};
+
+#endif // MESOSCOPIC_MODEL_H
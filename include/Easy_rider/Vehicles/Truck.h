@@ -4,15 +4,15 @@
 #include "Vehicle.h"
 
 /**
- * @class Truck
- * @brief Heavy truck - lower acceleration and braking.
+ * @struct Truck
+ * @brief Heavy truck - lower acceleration and braking (see Car).
  */
-class Truck final : public Vehicle {
-public:
-  Truck(const Graph<Intersection, Road> &graph, CongestionModel *congestion)
-      : Vehicle(graph, congestion,
-                IDMParams{/*a*/ 15.0, /*b*/ 20.0, /*v0*/ 25.0,
-                          /*T*/ 1.8, /*s0*/ 3.0, /*delta*/ 4.0}) {}
+struct Truck {
+  static constexpr VehicleClass kClass = VehicleClass::Truck;
+
+  /// IDM parameters shared by every truck.
+  static constexpr IDMParams kIDMParams{/*a*/ 15.0, /*b*/ 20.0, /*v0*/ 25.0,
+                                        /*T*/ 1.8, /*s0*/ 3.0, /*delta*/ 4.0};
 };
 
 #endif // TRUCK_H
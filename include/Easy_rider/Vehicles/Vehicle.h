@@ -2,6 +2,7 @@
 #define VEHICLE_H
 
 #include "Easy_rider/Congestion/CongestionModel.h"
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
 #include "Easy_rider/RoutingStrategies/RouteStrategy.h"
 #include "Easy_rider/TrafficInfrastructure/Graph.h"
 #include "Easy_rider/TrafficInfrastructure/Intersection.h"
@@ -9,64 +10,158 @@
 #include "IDM.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
+class LoadForecast;
+class StrategyTable;
+class VehicleStore;
+
 /**
  * @class Vehicle
- * @brief Base vehicle with longitudinal dynamics (IDM) and routing policy.
+ * @brief Route and routing policy of one vehicle in a VehicleStore.
+ *
+ * Vehicles are created by VehicleStore::emplace(). Speed, position and edge
+ * live in the store's flat arrays, which VehicleStore::advance() integrates
+ * for the whole fleet; a Vehicle only holds the cold state (route, strategy,
+ * reroute bookkeeping) and is touched when its vehicle changes edge or
+ * reroutes. Car and Truck are IDM parameter sets, not subclasses.
  *
  * Movement model:
  *  - Position is tracked along the current edge as a scalar in [0, length].
  *  - Speed is integrated using IDM; free-flow target speed is IDMParams::v0.
- *  - Effective edge speed is limited by the congestion model.
+ *  - Effective edge speed is limited by the congestion model, read from the
+ *    per-tick EdgeTimeTable snapshot when one is attached.
  *  - At an edge end, the next edge from @ref route_ is taken.
  *
  * Rerouting:
- *  - When congestion is detected (e.g., at edge entry), the vehicle may
- *    recompute its route using the configured strategy after a cooldown.
+ *  - When congestion is detected (e.g., at edge entry), the vehicle flags
+ *    that it wants a new route (see wantsReroute()); the owner decides when
+ *    to call recomputeRouteIfNeeded(), which honours a cooldown.
+ *  - The new route is planned from the next node and spliced in there; the
+ *    current edge is always finished first.
+ *  - With a reroute requester attached, the search is handed off (e.g. to a
+ *    worker pool) and the result is applied later via applyReroute().
+ */
+
+enum class StrategyAlgoritm {
+  Dijkstra,
+  AStar,
+  Incremental,
+  Hierarchical,
+  Adaptive
+};
+
+/// Number of StrategyAlgoritm values.
+inline constexpr std::size_t kStrategyAlgoritmCount = 5;
+
+/// Vehicle class; doubles as the class index into EdgeTimeTable.
+enum class VehicleClass : std::size_t { Car = 0, Truck = 1 };
+
+/// Number of VehicleClass values.
+inline constexpr std::size_t kVehicleClassCount = 2;
+
+/**
+ * @brief Generation-checked reference to a vehicle in a VehicleStore.
+ *
+ * Stays valid while the vehicle moves between slots; once the vehicle is
+ * removed, VehicleStore::find() returns null for it, even if its index is
+ * reused by a later vehicle.
  */
+struct VehicleHandle {
+  std::uint32_t index{std::numeric_limits<std::uint32_t>::max()};
+  std::uint32_t generation{0};
 
-enum class StrategyAlgoritm { Dijkstra, AStar };
+  bool operator==(const VehicleHandle &) const = default;
+};
 
 class Vehicle {
 public:
-  virtual ~Vehicle() = default;
-
-  /**
-   * @brief Construct a Vehicle with IDM configuration.
-   * @param graph        World graph reference.
-   * @param congestion   Congestion model pointer (can be null).
-   * @param params       Intelligent Driver Model parameters.
-   */
-  Vehicle(const Graph<Intersection, Road> &graph, CongestionModel *congestion,
-          const IDMParams &params);
+  Vehicle(Vehicle &&) noexcept = default;
+  Vehicle &operator=(Vehicle &&) noexcept = default;
+  Vehicle(const Vehicle &) = delete;
+  Vehicle &operator=(const Vehicle &) = delete;
 
   /// @brief Unique vehicle id.
   [[nodiscard]] int id() const { return id_; }
 
+  /// @brief Handle that finds this vehicle through VehicleStore::find().
+  [[nodiscard]] VehicleHandle handle() const { return handle_; }
+
+  /// @brief Vehicle class (Car, Truck, ...).
+  [[nodiscard]] VehicleClass vehicleClass() const { return class_; }
+
   /// @brief Assign a full route as a sequence of node ids (start -> goal).
   void setRoute(const std::vector<int> &routeIds);
 
-  /// @brief Advance simulation by dt seconds.
-  void update(double dt);
-
   /// @brief Notification hook: current edge is congested (may trigger reroute).
-  virtual void onCongestion();
+  void onCongestion();
 
   /// @brief Attempt to recompute route if cooldown has elapsed.
   void recomputeRouteIfNeeded();
 
-  /// @brief Replace routing strategy for this vehicle.
-  void setStrategy(StrategyAlgoritm algo);
+  /// @return true if a reroute is pending, allowed and not yet in flight.
+  [[nodiscard]] bool wantsReroute() const;
+
+  /// @return Distance left to the end of the current edge (0 at a node).
+  [[nodiscard]] double distanceToNextNode() const;
+
+  /**
+   * @return Estimated time to the goal along the current route.
+   *
+   * Leg times are priced once per route and refreshed only for edges that
+   * changed since (EdgeTimeTable::changesSince()), so this is O(1) between
+   * speed changes and O(changed edges) otherwise.
+   */
+  [[nodiscard]] double remainingETA() const;
+
+  /**
+   * @brief Apply a route planned from @p startId (the vehicle's next node).
+   *
+   * Compares the ETA of the current and new route, splices the new route in
+   * after the current edge and reports (vehId, oldETA, newETA) through the
+   * reroute callback. Stale results (the vehicle has already passed
+   * @p startId) are discarded and the reroute stays pending.
+   * @return true if the route was replaced.
+   */
+  bool applyReroute(int startId, const std::vector<int> &newRoute);
 
-  [[nodiscard]] const std::shared_ptr<RouteStrategy> &strategy() const {
-    return strategy_;
+  /// @brief Hand-off for asynchronous reroutes: (vehicle, startId, goalId).
+  using RerouteRequester = std::function<void(Vehicle &, int, int)>;
+
+  /// @brief Route searches go through @p fn instead of running inline. The
+  /// function is shared by the fleet and must outlive the vehicle (null
+  /// routes inline).
+  void setRerouteRequester(const RerouteRequester *fn) {
+    rerouteRequester_ = fn;
   }
 
+  /// @return true while an asynchronous reroute is outstanding.
+  [[nodiscard]] bool rerouteInFlight() const { return rerouteInFlight_; }
+
+  /// @brief Engines of this vehicle's class (shared; must outlive the
+  /// vehicle). Call before setStrategy().
+  void setStrategyTable(const StrategyTable *table) { strategies_ = table; }
+
+  /// @brief Route this vehicle with @p algo until the next fleet-wide switch
+  /// (StrategyTable::setActive()).
+  void setStrategy(StrategyAlgoritm algo);
+
+  /// @brief Load forecast fed with this vehicle's route (can be null).
+  void setLoadForecast(LoadForecast *forecast) { forecast_ = forecast; }
+
+  /// @return Engine this vehicle routes with (null without a strategy table).
+  [[nodiscard]] RouteStrategy *strategy() const;
+
+  /// @return Algorithm in use: the last setStrategy(), or the table's active
+  /// one if the class was switched since.
+  [[nodiscard]] StrategyAlgoritm strategyAlgorithm() const;
+
   /// @return current node id if exactly at a node, std::nullopt otherwise.
   [[nodiscard]] std::optional<int> currentNodeId() const;
 
@@ -81,74 +176,143 @@ public:
   };
 
   /// @brief Lightweight snapshot for rendering/telemetry.
-  [[nodiscard]] std::optional<RenderState> renderState() const {
-    if (route_.empty() || routeIndex_ + 1 >= route_.size())
-      return std::nullopt;
-    return RenderState{route_[routeIndex_], route_[routeIndex_ + 1],
-                       edgeProgress_, currentSpeed_};
-  }
+  [[nodiscard]] std::optional<RenderState> renderState() const;
 
   /// @brief Override IDM parameters.
-  void setIDMParams(const IDMParams &p) { idmParams_ = p; }
-
-  /// @brief Provide leader estimate for this simulation step (edge-aligned).
-  /// Call once per tick before update().
-  void setLeaderInfo(const LeaderInfo &info) { leader_ = info; }
+  void setIDMParams(const IDMParams &p);
 
-  /// @brief Clear leader information (e.g., when switching edges).
-  void clearLeaderInfo() { leader_.reset(); }
+  /// @return IDM parameters in use.
+  [[nodiscard]] const IDMParams &idmParams() const;
 
-  [[nodiscard]] double currentSpeed() const { return currentSpeed_; }
-  [[nodiscard]] double edgeProgress() const { return edgeProgress_; }
+  [[nodiscard]] double currentSpeed() const;
+  [[nodiscard]] double edgeProgress() const;
   [[nodiscard]] std::pair<int, int> currentEdge() const { return currentEdge_; }
+  [[nodiscard]] std::optional<std::size_t> currentEdgeIndex() const;
+
+  /// @return Position of this vehicle's kinematic state in its VehicleStore.
+  [[nodiscard]] std::size_t slot() const { return slot_; }
 
   // Convenience accessors mapped to IDM parameters.
-  [[nodiscard]] double maxSpeed() const { return idmParams_.v0; }
-  [[nodiscard]] double accelLimit() const { return idmParams_.a; }
-  [[nodiscard]] double brakeLimit() const { return idmParams_.b; }
+  [[nodiscard]] double maxSpeed() const { return idmParams().v0; }
+  [[nodiscard]] double accelLimit() const { return idmParams().a; }
+  [[nodiscard]] double brakeLimit() const { return idmParams().b; }
 
   [[nodiscard]] bool hasArrived() const noexcept;
 
   /// @brief Callback invoked after a re-route is applied:
   ///        (vehId, oldETA, newETA).
-  void setOnRerouteApplied(std::function<void(int, double, double)> cb) {
-    onRerouteApplied_ = std::move(cb);
+  using RerouteApplied = std::function<void(int, double, double)>;
+
+  /// @brief Report applied reroutes to @p cb (shared by the fleet; must
+  /// outlive the vehicle, or null).
+  void setOnRerouteApplied(const RerouteApplied *cb) {
+    onRerouteApplied_ = cb;
   }
 
-protected:
+private:
+  friend class MesoscopicModel;
+  friend class VehicleStore;
+
+  /**
+   * @brief Construct the routing record of store slot @p slot.
+   * @param store        Store holding the vehicle's kinematic state.
+   * @param slot         Slot in @p store.
+   * @param graph        World graph reference.
+   * @param congestion   Congestion model pointer (can be null).
+   * @param edgeTimes    Per-tick edge time snapshot (can be null; required for
+   *                     routing).
+   * @param vehicleClass Class of the vehicle (selects travel-time row).
+   */
+  Vehicle(VehicleStore &store, std::size_t slot,
+          const Graph<Intersection, Road> &graph, CongestionModel *congestion,
+          const EdgeTimeTable *edgeTimes, VehicleClass vehicleClass);
+
   /// @brief Find a road by (fromId -> toId). Returns nullptr if missing.
   [[nodiscard]] const Road *findEdge(int fromId, int toId) const;
 
+  /// @brief Effective (congestion-aware) speed on the edge with given index.
+  [[nodiscard]] double edgeSpeed(std::size_t edgeIdx) const;
+
   /// @brief Enter a new edge; resets progress and updates congestion counters.
   void enterEdge(int fromId, int toId);
 
   /// @brief Leave the current edge; updates congestion counters.
   void leaveEdge();
 
+  /// @brief Take the next leg after reaching the end of the current edge.
+  void finishEdge();
+
+  /// @brief Release shared state (lanes, forecast) before removal.
+  void retire();
+
+  /// @return true if the vehicle reached its goal or has no route to drive.
+  [[nodiscard]] bool finished() const noexcept;
+
+  /// @brief Point the store's lookahead at the leg after the current one.
+  void syncNextEdge();
+
+  /// @return Seconds since the last reroute (store clock).
+  [[nodiscard]] double sinceRecompute() const;
+
+  /// @brief Publish the remaining route to the load forecast (if any).
+  void replanForecast();
+
+  /// @brief Adopt the table's active algorithm after a fleet-wide switch.
+  void syncStrategy();
+
+  static constexpr std::size_t kNoEdge =
+      std::numeric_limits<std::size_t>::max();
+
+  /// @return Current travel time of edge @p edgeIdx (0 for kNoEdge).
+  [[nodiscard]] double legTime(std::size_t edgeIdx) const;
+
+  /// @brief Rebuild the ETA bookkeeping for route_ at the current edge
+  /// speeds, in the existing leg buffers.
+  void priceLegs();
+
+  /// @brief Start driving route_ from its first node.
+  void startRoute();
+
+  /// @brief Take over the route and leg buffers of @p retired (emptied, with
+  /// their capacity) so a new vehicle does not allocate them again.
+  void takeBuffers(Vehicle &retired);
+
+  /// @brief Re-price legs ahead whose edges changed since legEpoch_.
+  void refreshLegTimes() const;
+
+  VehicleStore *store_{};  ///< Holds speed, progress and edge index.
+  std::size_t slot_{0};    ///< Position in store_; updated when moved.
+  VehicleHandle handle_{}; ///< Set by the store.
   int id_{};
-  double currentSpeed_{};                   ///< Current speed along edge.
-  double edgeProgress_{};                   ///< Position along current edge.
   std::pair<int, int> currentEdge_{-1, -1}; // from -> to
 
   std::vector<int> route_;
   std::size_t routeIndex_{0};
-  std::shared_ptr<RouteStrategy> strategy_{};
+  const StrategyTable *strategies_{};
+  StrategyAlgoritm algo_{StrategyAlgoritm::AStar};
+  std::uint64_t strategyGeneration_{0}; ///< Table generation algo_ is from.
+  LoadForecast *forecast_{};
 
   const Graph<Intersection, Road> *graph_{};
   CongestionModel *congestion_{};
+  const EdgeTimeTable *edgeTimes_{};
+  VehicleClass class_{VehicleClass::Car};
 
   double recomputeCooldown_{3.0}; // seconds
-  double sinceRecompute_{1e9};
+  double recomputedAt_{-1e9};     ///< Store clock of the last reroute.
   bool pendingReroute_{false};
-
-  IDMParams idmParams_{};
-  std::optional<LeaderInfo> leader_{};
-
-  [[nodiscard]] double estimateRemainingETA(const std::vector<int> &path,
-                                            std::size_t routeIndex,
-                                            double sOnEdge) const;
-
-  std::function<void(int, double, double)> onRerouteApplied_{};
+  bool rerouteInFlight_{false};
+
+  // ETA bookkeeping for route_: leg i is route_[i] -> route_[i + 1].
+  std::vector<std::size_t> legEdges_;    ///< Edge index or kNoEdge per leg.
+  mutable std::vector<double> legTimes_; ///< Travel time of each leg.
+  std::vector<std::pair<std::size_t, std::size_t>>
+      legsByEdge_;                    ///< (edge, leg), sorted by edge.
+  mutable double timeAhead_{0.0};     ///< Sum of legTimes_ from routeIndex_.
+  mutable std::uint64_t legEpoch_{0}; ///< Table epoch legTimes_ reflect.
+
+  const RerouteApplied *onRerouteApplied_{};
+  const RerouteRequester *rerouteRequester_{};
 };
 
 #endif // VEHICLE_H
@@ -0,0 +1,292 @@
+/**
+ * @file VehicleStore.h
+ * @brief Structure-of-arrays storage of the fleet: kinematics in flat arrays,
+ * routes and routing policy in Vehicle records.
+ */
+#ifndef VEHICLE_STORE_H
+#define VEHICLE_STORE_H
+
+#include "Easy_rider/Concurrency/TaskScheduler.h"
+#include "Easy_rider/Congestion/CongestionModel.h"
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+#include "Easy_rider/TrafficInfrastructure/Graph.h"
+#include "Easy_rider/TrafficInfrastructure/Intersection.h"
+#include "Easy_rider/TrafficInfrastructure/Road.h"
+#include "EdgeLanes.h"
+#include "IDM.h"
+#include "MesoscopicModel.h"
+#include "Vehicle.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @class VehicleStore
+ * @brief Owns every vehicle; the per-tick update streams through contiguous
+ * arrays.
+ *
+ * @details
+ * Each vehicle occupies one slot. The hot state of slot i is speed[i],
+ * progress[i], edge[i] (plus the lookahead edge), the leader gap and speed
+ * of the current tick, and an index into a small table of IDM parameter
+ * sets (one per vehicle class, plus any per-vehicle overrides). advance()
+ * integrates all slots in a few passes over these arrays: IDM for vehicles
+ * behind a leader goes through idm_accel_batch(), one batch per parameter
+ * set. Only vehicles that reach the end of their edge touch their Vehicle
+ * record (route, strategy, ...).
+ *
+ * Both passes run on the scheduler over fixed chunks of kChunk slots. A slot
+ * reads only its own state and the leader arrays, which are filled from the
+ * start-of-tick positions before any vehicle moves. Edge transitions, and
+ * with them the lane and CongestionModel updates, are then applied serially
+ * in slot order. The chunking does not depend on the thread count, so
+ * advance() gives bit-identical results on any number of threads. (The
+ * simulation as a whole does only with synchronous, count-budgeted
+ * rerouting; see Parameters::simulationThreads().)
+ *
+ * Removing a vehicle moves the last one into its slot, so slots (and the
+ * iteration order) change on erase; vehicle ids and handles do not. A
+ * handle table (slot map) maps each VehicleHandle to the vehicle's current
+ * slot, with a generation per entry so handles of removed vehicles stop
+ * resolving. Vehicles that reach their goal are appended to an arrival list
+ * as they arrive, so eraseArrived() costs O(arrivals), not O(fleet).
+ * References returned by operator[] and emplace() are invalidated by
+ * emplace() and erase.
+ *
+ * With setMesoscopic(true) the fleet is moved by a MesoscopicModel instead:
+ * advanceMesoscopic() replaces updateLeaders() and advance(), and positions
+ * along an edge are interpolated from entry and exit times.
+ *
+ * Removed vehicles are kept in a pool and their route and ETA buffers are
+ * handed to the next vehicles emplaced, so a fleet that replaces arrivals
+ * as they happen stops allocating for them once the pool has warmed up.
+ */
+class VehicleStore {
+public:
+  /// Edge value meaning "not on an edge".
+  static constexpr std::uint32_t kNoEdge =
+      std::numeric_limits<std::uint32_t>::max();
+
+  /// Slots per parallel work item.
+  static constexpr std::size_t kChunk = 4096;
+
+  VehicleStore();
+
+  // Vehicles point back at their store.
+  VehicleStore(const VehicleStore &) = delete;
+  VehicleStore &operator=(const VehicleStore &) = delete;
+
+  /**
+   * @brief Add a vehicle of @p cls with that class's IDM parameters.
+   * @return The new vehicle (at rest, without a route).
+   */
+  Vehicle &emplace(const Graph<Intersection, Road> &graph,
+                   CongestionModel *congestion, const EdgeTimeTable *edgeTimes,
+                   VehicleClass cls);
+
+  /// @brief Remove the vehicle in @p slot (the last vehicle takes its slot).
+  void erase(std::size_t slot);
+
+  /**
+   * @brief Remove the vehicles that reached their goal (or were given an
+   * empty route) since the last call.
+   * @return Number of vehicles removed.
+   */
+  std::size_t eraseArrived();
+
+  /// @return The vehicle @p h refers to, or null if it was removed.
+  [[nodiscard]] Vehicle *find(VehicleHandle h) {
+    const std::uint32_t slot = slotOf(h);
+    return slot == kNoSlot ? nullptr : &cold_[slot];
+  }
+  [[nodiscard]] const Vehicle *find(VehicleHandle h) const {
+    const std::uint32_t slot = slotOf(h);
+    return slot == kNoSlot ? nullptr : &cold_[slot];
+  }
+
+  /// @brief Remove every vehicle for which @p pred returns true.
+  /// @return Number of vehicles removed.
+  template <class Pred> std::size_t eraseIf(Pred pred) {
+    std::size_t removed = 0;
+    for (std::size_t i = cold_.size(); i-- > 0;) {
+      if (pred(static_cast<const Vehicle &>(cold_[i]))) {
+        erase(i);
+        ++removed;
+      }
+    }
+    return removed;
+  }
+
+  /// @return Vehicles emplaced on the storage of a removed one so far.
+  [[nodiscard]] std::size_t recycled() const noexcept { return recycled_; }
+
+  [[nodiscard]] std::size_t size() const noexcept { return cold_.size(); }
+
+  /// @return Vehicles of class @p cls in the store, O(1).
+  [[nodiscard]] std::size_t count(VehicleClass cls) const noexcept {
+    return classCount_[static_cast<std::size_t>(cls)];
+  }
+  [[nodiscard]] bool empty() const noexcept { return cold_.empty(); }
+  void reserve(std::size_t n);
+
+  [[nodiscard]] Vehicle &operator[](std::size_t slot) { return cold_[slot]; }
+  [[nodiscard]] const Vehicle &operator[](std::size_t slot) const {
+    return cold_[slot];
+  }
+
+  [[nodiscard]] auto begin() noexcept { return cold_.begin(); }
+  [[nodiscard]] auto end() noexcept { return cold_.end(); }
+  [[nodiscard]] auto begin() const noexcept { return cold_.cbegin(); }
+  [[nodiscard]] auto end() const noexcept { return cold_.cend(); }
+
+  /**
+   * @brief Fill the leader arrays from the lanes, for every vehicle on an
+   * edge. Reads positions only, so every vehicle sees the start-of-tick state.
+   */
+  void updateLeaders(const EdgeTimeTable &times);
+
+  /**
+   * @brief Integrate IDM over @p dt for every vehicle on an edge and move
+   * vehicles that reached the end of their edge onto the next leg.
+   */
+  void advance(double dt, const EdgeTimeTable &times);
+
+  /**
+   * @brief Move the fleet with the MesoscopicModel (@p on) or with IDM.
+   * Switching carries every vehicle's position over; @p options apply from
+   * the next event on.
+   */
+  void setMesoscopic(bool on, const MesoscopicOptions &options = {});
+
+  /// @return true while the MesoscopicModel moves the fleet.
+  [[nodiscard]] bool mesoscopic() const noexcept { return mesoscopic_; }
+
+  /// @brief Process the mesoscopic exit events of the next @p dt seconds.
+  void advanceMesoscopic(double dt);
+
+  [[nodiscard]] const MesoscopicModel &mesoscopicModel() const noexcept {
+    return meso_;
+  }
+
+  /// @brief Run updateLeaders() and advance() on @p scheduler (null runs
+  /// them inline). Fleets of at most kChunk vehicles always run inline.
+  void setScheduler(TaskScheduler *scheduler) { scheduler_ = scheduler; }
+
+  /// @return Seconds advanced so far (reroute cooldowns are measured in it).
+  [[nodiscard]] double clock() const noexcept { return clock_; }
+
+  /// @brief Vehicles queued on each edge, in driving order.
+  [[nodiscard]] const EdgeLanes &lanes() const noexcept { return lanes_; }
+
+  /// @return Speed of the vehicle in @p slot.
+  [[nodiscard]] double speed(std::size_t slot) const { return speed_[slot]; }
+
+  /// @return Position along the current edge of the vehicle in @p slot.
+  [[nodiscard]] double progress(std::size_t slot) const {
+    return mesoscopic_ ? meso_.progress(*this, slot) : progress_[slot];
+  }
+
+  /// @return Edge index of the vehicle in @p slot, or kNoEdge.
+  [[nodiscard]] std::uint32_t edge(std::size_t slot) const {
+    return edge_[slot];
+  }
+
+  /// @return IDM parameters of the vehicle in @p slot.
+  [[nodiscard]] const IDMParams &params(std::size_t slot) const {
+    return paramSets_[params_[slot]];
+  }
+
+private:
+  friend class MesoscopicModel;
+  friend class Vehicle;
+
+  // Inputs of idm_accel_batch() for the vehicles of one parameter set.
+  struct Batch {
+    std::vector<std::uint32_t> slot;
+    std::vector<double> v, v0, gap, dv, out;
+
+    void clear() {
+      slot.clear();
+      v.clear();
+      v0.clear();
+      gap.clear();
+      dv.clear();
+    }
+  };
+
+  static constexpr std::uint32_t kNoSlot = kNoEdge;
+
+  // Slot-map entry: where a handle's vehicle lives now.
+  struct HandleEntry {
+    std::uint32_t slot{kNoSlot};
+    std::uint32_t generation{0};
+  };
+
+  // Current slot of @p h, or kNoSlot if stale.
+  [[nodiscard]] std::uint32_t slotOf(VehicleHandle h) const {
+    if (h.index >= handles_.size() ||
+        handles_[h.index].generation != h.generation)
+      return kNoSlot;
+    return handles_[h.index].slot;
+  }
+
+  // Unlink @p slot from edge @p edgeIdx (see EdgeLanes::leave()).
+  void leaveLane(std::size_t edgeIdx, std::uint32_t slot) {
+    lanes_.leave(edgeIdx, slot);
+    if (mesoscopic_)
+      meso_.onLeave(*this, edgeIdx);
+  }
+
+  // Index of @p p in paramSets_, adding it if new.
+  std::uint8_t paramsIndex(const IDMParams &p);
+
+  // Run fn(worker, begin, end) for every chunk of slots.
+  template <class Fn> void forEachChunk(Fn &&fn);
+
+  // advance() for slots [begin, end): accelerations and integration.
+  void advanceChunk(std::size_t begin, std::size_t end, double dt,
+                    const EdgeTimeTable &times, std::vector<Batch> &batches,
+                    std::vector<std::uint32_t> &finished);
+
+  // Hot state, indexed by slot.
+  std::vector<double> speed_;           ///< Speed along the edge.
+  std::vector<double> progress_;        ///< Position along the edge.
+  std::vector<std::uint32_t> edge_;     ///< Current edge or kNoEdge.
+  std::vector<std::uint32_t> nextEdge_; ///< Edge after it or kNoEdge.
+  std::vector<double> leaderGap_;       ///< Gap to leader / edge end.
+  std::vector<double> leaderSpeed_;     ///< Leader speed (0 if none).
+  std::vector<std::uint8_t> leaderPresent_; ///< Whether a leader exists.
+  std::vector<std::uint8_t> params_;        ///< Index into paramSets_.
+
+  std::vector<IDMParams> paramSets_; ///< Class defaults come first.
+  EdgeLanes lanes_;                  ///< Per-edge queues of slots.
+
+  // Cold state, indexed by slot.
+  std::vector<Vehicle> cold_;
+
+  std::vector<HandleEntry> handles_;       ///< By VehicleHandle::index.
+  std::vector<std::uint32_t> freeHandles_; ///< Unused handles_ entries.
+  std::vector<VehicleHandle> arrived_;     ///< Arrivals since eraseArrived().
+
+  std::array<std::size_t, kVehicleClassCount> classCount_{};
+
+  std::vector<Vehicle> retired_; ///< Removed vehicles, kept for their buffers.
+  std::vector<int> spareRoute_;  ///< Swapped with a route being replaced.
+  std::size_t recycled_{0};
+
+  // Scratch of advance(), kept to avoid per-tick allocation.
+  std::vector<double> target_; ///< Target speed per slot.
+  std::vector<double> accel_;  ///< Acceleration per slot.
+  PerWorker<std::vector<Batch>> batches_; ///< By parameter set.
+  std::vector<std::vector<std::uint32_t>> finished_; ///< By chunk.
+  TaskScheduler *scheduler_{};
+  double clock_{0.0};
+
+  MesoscopicModel meso_;
+  bool mesoscopic_{false};
+};
+
+#endif // VEHICLE_STORE_H
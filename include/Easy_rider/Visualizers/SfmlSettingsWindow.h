@@ -17,7 +17,7 @@
 class SfmlSettingsWindow {
 public:
   /// Pathfinding strategy selector.
-  enum class Algorithm { AStar, Dijkstra };
+  enum class Algorithm { AStar, Dijkstra, DStarLite };
   /**
    * @brief Optional hooks invoked when the settings window opens/closes.
    *
@@ -67,7 +67,7 @@ private:
   /// Poll and handle SFML events (close, mouse input, dragging).
   void processEvents_();
 
-  /// Render the current UI (labels + logarithmic speed slider).
+  /// Render the current UI (speed slider, algorithm radios, A* weight).
   void render_();
 
   std::unique_ptr<sf::RenderWindow>
@@ -75,7 +75,8 @@ private:
   const sf::Font &font_; ///< UI font.
   Callbacks cbs_;        ///< Open/close hooks.
 
-  bool dragging_ = false; ///< True while the speed knob is being dragged.
+  bool dragging_ = false;       ///< True while the speed knob is dragged.
+  bool draggingWeight_ = false; ///< True while the A* weight knob is dragged.
 
   Algorithm algorithm_ =
       Algorithm::AStar; ///< Selected pathfinding algorithm (default: A*).
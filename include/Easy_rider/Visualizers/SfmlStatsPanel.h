@@ -28,6 +28,15 @@ struct StatsSnapshot {
 
   /// Total number of reroutes performed.
   int rerouteCounts = 0;
+
+  /// Reroute requests deferred by the per-tick budget in the last tick.
+  int rerouteDeferred = 0;
+
+  /// Mean nodes settled per A* search.
+  double astarSettled = 0.0;
+
+  /// Mean A* route cost relative to Dijkstra (1 = optimal).
+  double astarCostRatio = 1.0;
 };
 
 /**
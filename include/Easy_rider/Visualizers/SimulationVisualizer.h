@@ -90,8 +90,9 @@ public:
   /**
    * @brief Drive the Simulation and rendering using wall-clock delta time.
    *
-   * Uses a variable-step integrator:
-   *   dtSim = wallSecondsSinceLastFrame * timeScale().
+   * Each frame hands wallSecondsSinceLastFrame * timeScale() to
+   * Simulation::advanceFrame(), which runs it as fixed steps; positions are
+   * drawn interpolated between the last two steps.
    *
    * The default implementation:
    *  - starts the simulation if attached,
@@ -114,7 +115,7 @@ public:
       last = now;
 
       if (simulation_) {
-        simulation_->update(wall * timeScale_);
+        simulation_->advanceFrame(wall * timeScale_);
       }
 
       renderFrame();
@@ -9,8 +9,10 @@
 #include "Easy_rider/TrafficInfrastructure/Intersection.h"
 #include "Easy_rider/TrafficInfrastructure/Road.h"
 
+#include <SFML/Graphics/Color.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -30,6 +32,12 @@ struct GraphDrawData {
   std::vector<std::pair<std::size_t, std::size_t>> edges; ///< Node index pairs.
 };
 
+/// @brief Convert a 0xAARRGGBB color from Parameters to an sf::Color.
+[[nodiscard]] inline sf::Color argbColor(std::uint32_t c) {
+  return sf::Color((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF,
+                   (c >> 24) & 0xFF);
+}
+
 /**
  * @brief Extract drawable graph data from the traffic infrastructure graph.
  *
@@ -41,7 +49,8 @@ struct GraphDrawData {
 makeGraphDrawData(const Graph<Intersection, Road> &g);
 
 /**
- * @brief Extract current vehicle world positions from a Simulation.
+ * @brief Extract vehicle world positions from a Simulation, interpolated
+ * between its last two steps (Simulation::interpolatedSnapshot()).
  *
  * The order of returned positions is unspecified and may change frame-to-frame.
  */
@@ -0,0 +1,180 @@
+/**
+ * @file TaskScheduler.cpp
+ * @brief Worker threads, deques and stealing of the TaskScheduler.
+ */
+#include "Easy_rider/Concurrency/TaskScheduler.h"
+
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Scheduler and worker index of a pool thread.
+thread_local const TaskScheduler *tlsScheduler = nullptr;
+thread_local std::size_t tlsWorker = 0;
+
+void pinToCpu([[maybe_unused]] std::thread &t,
+              [[maybe_unused]] std::size_t cpu) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  // Best effort: a failed pin leaves the thread unpinned.
+  pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#endif
+}
+
+} // namespace
+
+TaskScheduler::TaskScheduler(unsigned threads, bool pinThreads) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads_ = threads;
+  const std::size_t workers = std::max(1u, threads - 1);
+  queues_.reserve(workers + 1);
+  for (std::size_t q = 0; q <= workers; ++q)
+    queues_.push_back(std::make_unique<Queue>());
+
+  const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+  workers_.reserve(workers);
+  for (std::size_t w = 1; w <= workers; ++w) {
+    workers_.emplace_back([this, w] { workerLoop(w); });
+    if (pinThreads)
+      pinToCpu(workers_.back(), w % cpus);
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard lock(sleepMutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto &t : workers_)
+    t.join();
+}
+
+std::size_t TaskScheduler::currentWorker() const noexcept {
+  return tlsScheduler == this ? tlsWorker : 0;
+}
+
+void TaskScheduler::submit(Task task) {
+  Queue &q = *queues_[currentWorker()];
+  {
+    std::lock_guard lock(q.mutex);
+    q.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard lock(sleepMutex_);
+    ++queued_;
+  }
+  wake_.notify_one();
+}
+
+bool TaskScheduler::take(std::size_t worker, Task &task) {
+  auto popFront = [&task](Queue &q) {
+    std::lock_guard lock(q.mutex);
+    if (q.tasks.empty())
+      return false;
+    task = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+  };
+
+  bool found = false;
+  if (worker != 0) {
+    Queue &own = *queues_[worker];
+    std::lock_guard lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      found = true;
+    }
+  }
+  found = found || popFront(*queues_[0]);
+  // Steal round-robin, starting after our own deque.
+  for (std::size_t k = 1; !found && k < queues_.size(); ++k) {
+    const std::size_t victim = (worker + k) % queues_.size();
+    if (victim != 0)
+      found = popFront(*queues_[victim]);
+  }
+  if (found) {
+    std::lock_guard lock(sleepMutex_);
+    --queued_;
+  }
+  return found;
+}
+
+bool TaskScheduler::runPending() {
+  Task task;
+  if (!take(currentWorker(), task))
+    return false;
+  task();
+  return true;
+}
+
+void TaskScheduler::workerLoop(std::size_t worker) {
+  tlsScheduler = this;
+  tlsWorker = worker;
+  Task task;
+  while (true) {
+    if (take(worker, task)) {
+      task();
+      task = nullptr; // release captures before sleeping
+      continue;
+    }
+    std::unique_lock lock(sleepMutex_);
+    wake_.wait(lock, [this] { return queued_ > 0 || stopping_; });
+    if (stopping_ && queued_ == 0)
+      return;
+  }
+}
+
+TaskGroup::~TaskGroup() {
+  try {
+    wait();
+  } catch (...) {
+  }
+}
+
+void TaskGroup::run(TaskScheduler::Task task) {
+  {
+    std::lock_guard lock(mutex_);
+    ++pending_;
+  }
+  scheduler_.submit([this, task = std::move(task)] {
+    std::exception_ptr error;
+    try {
+      task();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard lock(mutex_);
+    if (error && !error_)
+      error_ = error;
+    if (--pending_ == 0)
+      done_.notify_all();
+  });
+}
+
+void TaskGroup::wait() {
+  while (true) {
+    {
+      std::lock_guard lock(mutex_);
+      if (pending_ == 0)
+        break;
+    }
+    if (scheduler_.runPending())
+      continue;
+    // Nothing left to help with: the remaining tasks are running elsewhere.
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+  }
+  std::lock_guard lock(mutex_);
+  if (error_)
+    std::rethrow_exception(std::exchange(error_, nullptr));
+}
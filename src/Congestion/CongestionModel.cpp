@@ -28,6 +28,14 @@ int CongestionModel::capacityFor(const Road &road) const {
   return std::max(1, cap);
 }
 
+double CongestionModel::freeSpeed(const Road &road) const {
+  double v_free = std::max(1, road.getMaxSpeed());
+  const auto it = state_.find(EdgeKey{road.getFromId(), road.getToId()});
+  if (it != state_.end() && it->second.speedLimitOverride)
+    v_free = std::min(v_free, *it->second.speedLimitOverride);
+  return v_free;
+}
+
 double CongestionModel::effectiveSpeed(const Road &road) const {
   const EdgeKey key{road.getFromId(), road.getToId()};
 
@@ -43,22 +51,10 @@ double CongestionModel::effectiveSpeed(const Road &road) const {
 
   if (N <= 0)
     return v_free;
-
-  const int x = capacityFor(road);
-
-  // Tier index m = ceil(N/x). Divisor = 2^(m-1).
-  const int m = (N + x - 1) / x;           // ceil division, m >= 1
-  const int exponent = std::max(0, m - 1); // 0 in first tier
-  const double ratio = std::ldexp(1.0, -exponent);
-  const double v_eff = std::max(1e-6, v_free * ratio);
-  return v_eff;
+  return speedForLoad(v_free, capacityFor(road), N);
 }
 
 double CongestionModel::edgeTime(const Road &road, int vehicleMaxSpeed) const {
   // Time = length / min(vehicleMaxSpeed, effectiveSpeed(road)).
-  const double len = std::max(1e-9, road.getLength());
-  const double v_eff = effectiveSpeed(road);
-  const double v_vehicle = static_cast<double>(std::max(1, vehicleMaxSpeed));
-  const double v = std::min(v_vehicle, v_eff);
-  return len / v;
+  return travelTime(road.getLength(), effectiveSpeed(road), vehicleMaxSpeed);
 }
@@ -0,0 +1,97 @@
+/**
+ * @file EdgeTimeTable.cpp
+ * @brief Implementation of the per-tick edge speed/travel-time snapshot.
+ */
+
+#include "Easy_rider/Congestion/EdgeTimeTable.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+EdgeTimeTable::EdgeTimeTable(std::vector<int> classSpeedCaps)
+    : classSpeedCaps_(std::move(classSpeedCaps)),
+      vmax_(classSpeedCaps_.size(), 0.0) {}
+
+void EdgeTimeTable::rebuild(const Graph<Intersection, Road> &graph,
+                            const CongestionModel &congestion) {
+  const auto &edges = graph.getEdges();
+  const std::size_t n = edges.size();
+  const std::size_t classes = classCount();
+
+  bool changed = false;
+  const bool resized = lengths_.size() != n;
+  if (resized) {
+    lengths_.assign(n, 0.0);
+    speed_.assign(n, 0.0);
+    freeSpeed_.assign(n, 0.0);
+    capacity_.assign(n, 0);
+    times_.assign(classes * n, 0.0);
+    changed = true;
+  }
+
+  scratch_.clear();
+  maxFreeSpeed_ = 0.0;
+  for (std::size_t e = 0; e < n; ++e) {
+    const Road &road = edges[e];
+    freeSpeed_[e] = congestion.freeSpeed(road);
+    capacity_[e] = congestion.capacityFor(road);
+    maxFreeSpeed_ = std::max(maxFreeSpeed_, freeSpeed_[e]);
+
+    const double v = congestion.effectiveSpeed(road);
+    if (v != speed_[e] || lengths_[e] != road.getLength()) {
+      speed_[e] = v;
+      lengths_[e] = road.getLength();
+      scratch_.push_back(e);
+      changed = true;
+    }
+  }
+
+  if (!changed)
+    return;
+  changed_.swap(scratch_);
+
+  for (std::size_t c = 0; c < classes; ++c) {
+    double *row = times_.data() + c * n;
+    double vmax = 0.0;
+    for (std::size_t e = 0; e < n; ++e) {
+      row[e] = CongestionModel::travelTime(lengths_[e], speed_[e],
+                                           classSpeedCaps_[c]);
+      if (lengths_[e] > 0.0)
+        vmax = std::max(vmax, lengths_[e] / row[e]);
+    }
+    assert((n == 0 || vmax > 0.0) && "No positive effective speed found");
+    vmax_[c] = vmax;
+  }
+  ++epoch_;
+
+  // historyStart_[i] is where epoch historyBase_ + 1 + i begins. Drop the
+  // whole history on a resize or once it outgrows a full rescan.
+  if (resized || history_.size() + changed_.size() > 2 * n) {
+    history_.clear();
+    historyStart_.clear();
+    historyBase_ = epoch_;
+  } else {
+    historyStart_.push_back(history_.size());
+    history_.insert(history_.end(), changed_.begin(), changed_.end());
+  }
+}
+
+std::optional<std::span<const std::size_t>>
+EdgeTimeTable::changesSince(std::uint64_t since) const {
+  if (since < historyBase_)
+    return std::nullopt;
+  if (since >= epoch_)
+    return std::span<const std::size_t>{};
+  const std::size_t first = historyStart_[since - historyBase_];
+  return std::span<const std::size_t>{history_}.subspan(first);
+}
+
+std::vector<double>
+EdgeTimeTable::freeFlowTimes(std::size_t classIdx) const {
+  std::vector<double> out(edgeCount());
+  for (std::size_t e = 0; e < out.size(); ++e)
+    out[e] = CongestionModel::travelTime(lengths_[e], freeSpeed_[e],
+                                         classSpeedCaps_[classIdx]);
+  return out;
+}
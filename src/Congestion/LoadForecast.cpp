@@ -0,0 +1,152 @@
+/**
+ * @file LoadForecast.cpp
+ * @brief Implementation of the time-bucketed edge load forecast.
+ */
+
+#include "Easy_rider/Congestion/LoadForecast.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+ForecastTable::ForecastTable(double bucketSeconds, std::size_t horizonBuckets)
+    : bucketSeconds_(std::max(1e-3, bucketSeconds)),
+      horizon_(std::max<std::size_t>(1, horizonBuckets)) {}
+
+void ForecastTable::resize(std::size_t edgeCount) {
+  edges_ = edgeCount;
+  counts_.assign(edgeCount * horizon_, 0);
+}
+
+void ForecastTable::advanceTo(double now) {
+  now_ = now;
+  const std::int64_t target = bucketOf(now);
+  if (target <= base_)
+    return;
+
+  // Clear the slots of buckets that fell behind (at most the whole ring).
+  const std::int64_t expired = std::min(
+      target - base_, static_cast<std::int64_t>(horizon_));
+  for (std::int64_t b = base_; b < base_ + expired; ++b) {
+    const std::size_t s = slot(b);
+    for (std::size_t e = 0; e < edges_; ++e)
+      counts_[e * horizon_ + s] = 0;
+  }
+  base_ = target;
+}
+
+std::pair<std::int64_t, std::int64_t>
+ForecastTable::add(std::size_t edgeIdx, std::int64_t first, std::int64_t last,
+                   int delta) {
+  first = std::max(first, base_);
+  last = std::min(last, lastBucket());
+  if (edgeIdx >= edges_)
+    return {first, first - 1};
+
+  int *row = counts_.data() + edgeIdx * horizon_;
+  for (std::int64_t b = first; b <= last; ++b) {
+    int &c = row[slot(b)];
+    c = std::max(0, c + delta);
+  }
+  return {first, last};
+}
+
+LoadForecast::LoadForecast(const Graph<Intersection, Road> &graph,
+                           const EdgeTimeTable &edgeTimes,
+                           double bucketSeconds, std::size_t horizonBuckets)
+    : graph_(graph), edgeTimes_(edgeTimes),
+      table_(bucketSeconds, horizonBuckets) {
+  table_.resize(graph_.getEdges().size());
+}
+
+void LoadForecast::advanceTo(double now) {
+  if (table_.edgeCount() != graph_.getEdges().size()) {
+    table_.resize(graph_.getEdges().size());
+    plans_.clear();
+  }
+  table_.advanceTo(now);
+}
+
+void LoadForecast::replan(int vehicleId, std::size_t classIdx,
+                          const std::vector<int> &route,
+                          std::size_t routeIndex, double sOnEdge) {
+  forget(vehicleId);
+  if (route.size() < 2 || routeIndex + 1 >= route.size())
+    return;
+
+  Plan &plan = plans_[vehicleId];
+  plan.classIdx = classIdx;
+  plan.edges.reserve(route.size() - routeIndex - 1);
+  for (std::size_t i = routeIndex; i + 1 < route.size(); ++i) {
+    const auto eIdx = graph_.edgeIndexOf(route[i], route[i + 1]);
+    if (!eIdx)
+      break;
+    plan.edges.push_back(*eIdx);
+  }
+  if (plan.edges.empty()) {
+    plans_.erase(vehicleId);
+    return;
+  }
+
+  const double len = edgeTimes_.length(plan.edges.front());
+  const double fraction =
+      len > 0.0 ? std::clamp((len - sOnEdge) / len, 0.0, 1.0) : 0.0;
+  predict(plan, 0, table_.now(), fraction);
+}
+
+void LoadForecast::onEnterEdge(int vehicleId, std::size_t edgeIdx) {
+  const auto it = plans_.find(vehicleId);
+  if (it == plans_.end())
+    return;
+  Plan &plan = it->second;
+
+  const auto pos = std::find(plan.edges.begin() + plan.next, plan.edges.end(),
+                             edgeIdx);
+  const auto k = static_cast<std::size_t>(pos - plan.edges.begin());
+  retire(plan, plan.next, std::min(k, plan.spans.size()));
+  plan.next = k;
+  if (k >= plan.edges.size()) {
+    plans_.erase(it); // Left the planned route; wait for the next replan.
+    return;
+  }
+
+  // On schedule (within one bucket) and still inside the prediction: done.
+  if (k < plan.spans.size() &&
+      std::abs(plan.spans[k].first - table_.bucketOf(table_.now())) <= 1)
+    return;
+
+  // Skipped edges (past the old prediction) hold an empty range.
+  retire(plan, k, plan.spans.size());
+  plan.spans.resize(k, {0, -1});
+  predict(plan, k, table_.now(), 1.0);
+}
+
+void LoadForecast::forget(int vehicleId) {
+  const auto it = plans_.find(vehicleId);
+  if (it == plans_.end())
+    return;
+  retire(it->second, it->second.next, it->second.spans.size());
+  plans_.erase(it);
+}
+
+void LoadForecast::predict(Plan &plan, std::size_t from, double t,
+                           double firstFraction) {
+  const std::int64_t horizonEnd = table_.lastBucket();
+  for (std::size_t i = from; i < plan.edges.size(); ++i) {
+    const std::int64_t first = table_.bucketOf(t);
+    if (first > horizonEnd)
+      break;
+    double w = edgeTimes_.travelTime(plan.classIdx, plan.edges[i]);
+    if (i == from)
+      w *= firstFraction;
+    t += w;
+    plan.spans.push_back(
+        table_.add(plan.edges[i], first, table_.bucketOf(t), +1));
+  }
+}
+
+void LoadForecast::retire(Plan &plan, std::size_t from, std::size_t to) {
+  for (std::size_t i = from; i < to; ++i) {
+    const auto [first, last] = plan.spans[i];
+    table_.add(plan.edges[i], first, last, -1);
+  }
+}
@@ -64,8 +64,10 @@ void HighwayGenerator::generate(Graph<Intersection, Road> &graph) {
       const auto &A = nodes[ei.u];
       const auto &B = nodes[ei.v];
 
-      auto r1 = graph.addEdgeIfNotExists(Road(A, B, defaultSpeed_, capacity_));
-      auto r2 = graph.addEdgeIfNotExists(Road(B, A, defaultSpeed_, capacity_));
+      auto r1 = graph.addEdgeIfNotExists(
+          Road(A, B, defaultSpeed_, capacity_, RoadClass::Highway));
+      auto r2 = graph.addEdgeIfNotExists(
+          Road(B, A, defaultSpeed_, capacity_, RoadClass::Highway));
 
       // only unite if both inserted
       if ((r1 == Result::Success || r1 == Result::AlreadyExists) &&
@@ -141,7 +141,9 @@ void MotorwayGenerator::generate(Graph<Intersection, Road> &graph) {
   for (std::size_t i = 0; i + 1 < smooth.size(); ++i) {
     const auto &P = smooth[i];
     const auto &Q = smooth[i + 1];
-    graph.addEdgeIfNotExists(Road(P, Q, defaultSpeed_, capacity_));
-    graph.addEdgeIfNotExists(Road(Q, P, defaultSpeed_, capacity_));
+    graph.addEdgeIfNotExists(
+        Road(P, Q, defaultSpeed_, capacity_, RoadClass::Motorway));
+    graph.addEdgeIfNotExists(
+        Road(Q, P, defaultSpeed_, capacity_, RoadClass::Motorway));
   }
 }
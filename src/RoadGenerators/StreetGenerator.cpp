@@ -27,8 +27,10 @@ void StreetGenerator::generate(Graph<Intersection, Road> &graph) {
     for (size_t t = 0; t < m; ++t) {
       const auto &A = nodes[i];
       const auto &B = nodes[dists[t].second];
-      graph.addEdgeIfNotExists(Road(A, B, defaultSpeed_, capacity_));
-      graph.addEdgeIfNotExists(Road(B, A, defaultSpeed_, capacity_));
+      graph.addEdgeIfNotExists(
+          Road(A, B, defaultSpeed_, capacity_, RoadClass::Street));
+      graph.addEdgeIfNotExists(
+          Road(B, A, defaultSpeed_, capacity_, RoadClass::Street));
     }
   }
 }
@@ -1,14 +1,32 @@
 #include "Easy_rider/RoutingStrategies/AStarStrategy.h"
+#include "Easy_rider/RoutingStrategies/DijkstraStrategy.h"
 
 #include <cassert>
 #include <cmath>
 #include <limits>
 #include <queue>
+#include <utility>
 
-std::vector<int>
-AStarStrategy::computeRoute(int startId, int goalId,
-                            const Graph<Intersection, Road> &graph) {
-  assert(timeFn_ && "timeFn must not be null");
+namespace {
+
+// Sum of edge weights along a route of node ids.
+double routeCost(const std::vector<int> &route,
+                 const Graph<Intersection, Road> &graph,
+                 const EdgeTimes &weights) {
+  double cost = 0.0;
+  for (std::size_t i = 0; i + 1 < route.size(); ++i) {
+    if (const auto e = graph.edgeIndexOf(route[i], route[i + 1]))
+      cost += weights[*e];
+  }
+  return cost;
+}
+
+} // namespace
+
+SearchResult
+AStarStrategy::search(int startId, int goalId,
+                      const Graph<Intersection, Road> &graph) const {
+  assert(times_ && "times must not be null");
 
   const auto &nodes = graph.getNodes();
   if (nodes.empty())
@@ -24,7 +42,11 @@ AStarStrategy::computeRoute(int startId, int goalId,
 
   const int n = static_cast<int>(nodes.size());
   const double INF = std::numeric_limits<double>::infinity();
-  const double vmax = computeVmaxUpperBound(graph, timeFn_);
+  const EdgeTimes weights = times_->travelTimes(classIdx_);
+  const double vmax = times_->vmaxUpperBound(classIdx_);
+  assert(weights.size() == graph.getEdges().size() &&
+         "edge time snapshot is out of date");
+  assert(vmax > 0.0 && "No positive effective speed found");
 
   auto euclidIdx = [&](int aIdx, int bIdx) -> double {
     const auto &a = nodes.at(static_cast<size_t>(aIdx));
@@ -36,7 +58,9 @@ AStarStrategy::computeRoute(int startId, int goalId,
     return std::hypot(dx, dy);
   };
 
-  auto h = [&](int uIdx) -> double { return euclidIdx(uIdx, gIdx) / vmax; };
+  // Weighted heuristic: f = g + w * h.
+  const double hScale = weight_ / vmax;
+  auto h = [&](int uIdx) -> double { return euclidIdx(uIdx, gIdx) * hScale; };
 
   std::vector<double> gScore(n, INF);
   std::vector<int> parent(n, -1);
@@ -47,6 +71,7 @@ AStarStrategy::computeRoute(int startId, int goalId,
 
   gScore[sIdx] = 0.0;
   open.emplace(h(sIdx), sIdx);
+  std::size_t settled = 0;
 
   while (!open.empty()) {
     auto [f, uIdx] = open.top();
@@ -54,16 +79,14 @@ AStarStrategy::computeRoute(int startId, int goalId,
     if (closed[uIdx])
       continue;
     closed[uIdx] = 1;
+    ++settled;
     if (uIdx == gIdx)
       break;
 
-    for (const auto &nbr : graph.outgoing(uIdx)) {
-      const int vIdx = nbr.first;
-      const Road &e = nbr.second;
-
-      const double w = timeFn_(e);
+    for (const auto &[vIdx, eIdx] : graph.outgoingIndices(uIdx)) {
+      const double w = weights[eIdx];
       assert(std::isfinite(w) && w >= 0.0 &&
-             "timeFn(edge) must be finite and >= 0");
+             "edge time must be finite and >= 0");
 
       const double tentative = gScore[uIdx] + w;
       if (tentative < gScore[vIdx]) {
@@ -75,5 +98,14 @@ AStarStrategy::computeRoute(int startId, int goalId,
     }
   }
 
-  return rebuildPathIdsFromParents(sIdx, gIdx, parent, graph);
+  std::vector<int> route = rebuildPathIdsFromParents(sIdx, gIdx, parent, graph);
+  if (log_ && log_->recordSearch(settled) && !route.empty()) {
+    const SearchResult best =
+        DijkstraStrategy(*times_, classIdx_).search(startId, goalId, graph);
+    if (!best.route.empty())
+      log_->recordSample(routeCost(route, graph, weights),
+                         routeCost(best.route, graph, weights), settled,
+                         best.settled);
+  }
+  return {std::move(route), settled};
 }
@@ -0,0 +1,154 @@
+#include "Easy_rider/RoutingStrategies/AdaptiveRouter.h"
+#include "Easy_rider/RoutingStrategies/AStarStrategy.h"
+#include "Easy_rider/RoutingStrategies/AllPairsRouter.h"
+#include "Easy_rider/RoutingStrategies/DestinationTreeCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double kSmoothing = 0.2; // weight of a new measurement
+
+} // namespace
+
+AdaptiveRouter::AdaptiveRouter(const Graph<Intersection, Road> &graph,
+                               std::size_t classIdx, AllPairsRouter *allPairs,
+                               DestinationTreeCache *cache,
+                               HierarchyOptions hierarchy)
+    : graph_(graph), classIdx_(classIdx), allPairs_(allPairs), cache_(cache),
+      hierarchy_(hierarchy) {
+  const auto &nodes = graph_.getNodes();
+  if (!nodes.empty()) {
+    int minX = nodes[0].getX(), maxX = minX;
+    int minY = nodes[0].getY(), maxY = minY;
+    for (const auto &n : nodes) {
+      minX = std::min(minX, n.getX());
+      maxX = std::max(maxX, n.getX());
+      minY = std::min(minY, n.getY());
+      maxY = std::max(maxY, n.getY());
+    }
+    extent_ = std::max(1.0, std::hypot(static_cast<double>(maxX - minX),
+                                       static_cast<double>(maxY - minY)));
+  }
+  hasLayers_ = std::any_of(
+      graph_.getEdges().begin(), graph_.getEdges().end(),
+      [](const Road &r) { return r.getRoadClass() != RoadClass::Street; });
+}
+
+bool AdaptiveRouter::available(RouteEngine engine) const {
+  switch (engine) {
+  case RouteEngine::Tree:
+    return allPairs_ || cache_;
+  case RouteEngine::Hierarchy:
+    return hasLayers_;
+  case RouteEngine::AStar:
+  case RouteEngine::Bidirectional:
+    break;
+  }
+  return true;
+}
+
+std::size_t AdaptiveRouter::bucketOf(int startId, int goalId) const {
+  if (!graph_.hasId(startId) || !graph_.hasId(goalId))
+    return 0;
+  const auto &s = graph_.getNodes()[graph_.indexOfId(startId)];
+  const auto &g = graph_.getNodes()[graph_.indexOfId(goalId)];
+  const double d = std::hypot(static_cast<double>(s.getX() - g.getX()),
+                              static_cast<double>(s.getY() - g.getY()));
+  const auto b = static_cast<std::size_t>(
+      d / extent_ * static_cast<double>(kDistanceBuckets));
+  return std::min(b, kDistanceBuckets - 1);
+}
+
+RouteEngine AdaptiveRouter::choose(std::size_t bucket) {
+  std::lock_guard lock(mutex_);
+  auto &cells = model_[bucket];
+  const std::uint64_t query = ++queries_[bucket];
+
+  std::size_t pick = kRouteEngineCount;
+  for (std::size_t e = 0; e < kRouteEngineCount; ++e) {
+    if (available(static_cast<RouteEngine>(e)) && cells[e].samples < kWarmup) {
+      pick = e;
+      break;
+    }
+  }
+  if (pick == kRouteEngineCount) {
+    const bool explore = query % kExploreEvery == 0;
+    for (std::size_t e = 0; e < kRouteEngineCount; ++e) {
+      if (!available(static_cast<RouteEngine>(e)))
+        continue;
+      if (pick == kRouteEngineCount ||
+          (explore ? cells[e].lastUsed < cells[pick].lastUsed
+                   : cells[e].seconds < cells[pick].seconds))
+        pick = e;
+    }
+  }
+  cells[pick].lastUsed = query;
+  ++histogram_[pick];
+  return static_cast<RouteEngine>(pick);
+}
+
+void AdaptiveRouter::record(std::size_t bucket, RouteEngine engine,
+                            double seconds) {
+  std::lock_guard lock(mutex_);
+  Cell &c = model_[bucket][static_cast<std::size_t>(engine)];
+  c.seconds = c.samples ? c.seconds + kSmoothing * (seconds - c.seconds)
+                        : seconds;
+  ++c.samples;
+}
+
+std::vector<int> AdaptiveRouter::run(RouteEngine engine,
+                                     const EdgeTimeTable &times, int startId,
+                                     int goalId) {
+  switch (engine) {
+  case RouteEngine::Tree:
+    if (allPairs_) {
+      if (auto route = allPairs_->tryRoute(startId, goalId))
+        return std::move(*route);
+    }
+    if (cache_) {
+      if (auto route = cache_->tryRoute(startId, goalId))
+        return std::move(*route);
+    }
+    break;
+  case RouteEngine::Bidirectional:
+    return HierarchicalStrategy(
+               times, classIdx_,
+               {std::numeric_limits<double>::infinity(), 0.0})
+        .computeRoute(startId, goalId, graph_);
+  case RouteEngine::Hierarchy:
+    return HierarchicalStrategy(times, classIdx_, hierarchy_)
+        .computeRoute(startId, goalId, graph_);
+  case RouteEngine::AStar:
+    break;
+  }
+  return AStarStrategy(times, classIdx_).computeRoute(startId, goalId, graph_);
+}
+
+std::vector<int> AdaptiveRouter::route(const EdgeTimeTable &times, int startId,
+                                       int goalId) {
+  const std::size_t bucket = bucketOf(startId, goalId);
+  const RouteEngine engine = choose(bucket);
+  const auto t0 = std::chrono::steady_clock::now();
+  std::vector<int> path = run(engine, times, startId, goalId);
+  record(bucket, engine,
+         std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+             .count());
+  return path;
+}
+
+std::array<std::uint64_t, kRouteEngineCount>
+AdaptiveRouter::histogram() const {
+  std::lock_guard lock(mutex_);
+  return histogram_;
+}
+
+double AdaptiveRouter::latency(RouteEngine engine, std::size_t bucket) const {
+  std::lock_guard lock(mutex_);
+  if (bucket >= kDistanceBuckets)
+    return 0.0;
+  return model_[bucket][static_cast<std::size_t>(engine)].seconds;
+}
@@ -0,0 +1,349 @@
+/**
+ * @file AllPairsRouter.cpp
+ * @brief Blocked Floyd-Warshall tables and their background maintenance.
+ */
+#include "Easy_rider/RoutingStrategies/AllPairsRouter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+/**
+ * Min-plus relaxation of tile C (rows [i0, i1), columns [j0, j1)) through
+ * intermediates [k0, k1): C[i][j] = min(C[i][j], D[i][k] + D[k][j]).
+ */
+void relaxTile(std::size_t n, double *__restrict dist,
+               std::int32_t *__restrict next, std::size_t i0, std::size_t i1,
+               std::size_t j0, std::size_t j1, std::size_t k0,
+               std::size_t k1) {
+  for (std::size_t k = k0; k < k1; ++k) {
+    const double *dk = dist + k * n;
+    for (std::size_t i = i0; i < i1; ++i) {
+      double *di = dist + i * n;
+      const double dik = di[k];
+      if (dik == INF)
+        continue;
+      std::int32_t *ni = next + i * n;
+      const std::int32_t nik = ni[k];
+      for (std::size_t j = j0; j < j1; ++j) {
+        const double c = dik + dk[j];
+        const bool better = c < di[j];
+        di[j] = better ? c : di[j];
+        ni[j] = better ? nik : ni[j];
+      }
+    }
+  }
+}
+
+} // namespace
+
+AllPairsTable AllPairsTable::build(std::size_t n, const std::vector<int> &from,
+                                   const std::vector<int> &to,
+                                   EdgeTimes weights) {
+  AllPairsTable t;
+  t.n = n;
+  t.dist.assign(n * n, INF);
+  t.next.assign(n * n, -1);
+  for (std::size_t i = 0; i < n; ++i) {
+    t.dist[i * n + i] = 0.0;
+    t.next[i * n + i] = static_cast<std::int32_t>(i);
+  }
+  for (std::size_t e = 0; e < weights.size(); ++e) {
+    const auto idx = static_cast<std::size_t>(from[e]) * n +
+                     static_cast<std::size_t>(to[e]);
+    if (weights[e] < t.dist[idx]) {
+      t.dist[idx] = weights[e];
+      t.next[idx] = to[e];
+    }
+  }
+
+  // Three phases per diagonal block: the pivot tile, its row and column of
+  // tiles, then every remaining tile.
+  const std::size_t blocks = (n + kBlock - 1) / kBlock;
+  auto lo = [](std::size_t b) { return b * kBlock; };
+  auto hi = [n](std::size_t b) { return std::min(n, (b + 1) * kBlock); };
+  double *d = t.dist.data();
+  std::int32_t *nx = t.next.data();
+  for (std::size_t kb = 0; kb < blocks; ++kb) {
+    const std::size_t k0 = lo(kb), k1 = hi(kb);
+    relaxTile(n, d, nx, k0, k1, k0, k1, k0, k1);
+    for (std::size_t b = 0; b < blocks; ++b) {
+      if (b == kb)
+        continue;
+      relaxTile(n, d, nx, k0, k1, lo(b), hi(b), k0, k1);
+      relaxTile(n, d, nx, lo(b), hi(b), k0, k1, k0, k1);
+    }
+    for (std::size_t ib = 0; ib < blocks; ++ib) {
+      if (ib == kb)
+        continue;
+      for (std::size_t jb = 0; jb < blocks; ++jb) {
+        if (jb != kb)
+          relaxTile(n, d, nx, lo(ib), hi(ib), lo(jb), hi(jb), k0, k1);
+      }
+    }
+  }
+  return t;
+}
+
+void AllPairsTable::lowerEdge(int u, int v, double w) {
+  const auto uu = static_cast<std::size_t>(u);
+  const auto vv = static_cast<std::size_t>(v);
+  const double *dv = dist.data() + vv * n;
+  // The loop reads column u (dist[i][u]) and row v (dist[v][j]). Neither
+  // changes while it runs: a path i -> u or v -> j through the new edge
+  // would contain a cycle, which with weights > 0 is never shorter. So the
+  // update can run in place.
+  for (std::size_t i = 0; i < n; ++i) {
+    const double diu = dist[i * n + uu];
+    if (diu == INF)
+      continue;
+    const std::int32_t first = i == uu ? v : next[i * n + uu];
+    double *di = dist.data() + i * n;
+    std::int32_t *ni = next.data() + i * n;
+    for (std::size_t j = 0; j < n; ++j) {
+      const double c = diu + w + dv[j];
+      const bool better = c < di[j];
+      di[j] = better ? c : di[j];
+      ni[j] = better ? first : ni[j];
+    }
+  }
+}
+
+std::vector<int> AllPairsTable::pathIndices(int i, int j) const {
+  const auto jj = static_cast<std::size_t>(j);
+  if (dist[static_cast<std::size_t>(i) * n + jj] == INF)
+    return {};
+  std::vector<int> path{i};
+  for (int cur = i; cur != j && path.size() <= n;) {
+    cur = next[static_cast<std::size_t>(cur) * n + jj];
+    if (cur < 0)
+      return {};
+    path.push_back(cur);
+  }
+  return path;
+}
+
+AllPairsRouter::AllPairsRouter(const Graph<Intersection, Road> &graph,
+                               std::size_t classIdx, TaskScheduler *scheduler)
+    : graph_(graph), classIdx_(classIdx) {
+  if (scheduler)
+    builds_.emplace(*scheduler);
+}
+
+AllPairsRouter::~AllPairsRouter() {
+  if (!builds_)
+    return;
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+    pending_.reset();
+  }
+  builds_->wait();
+}
+
+void AllPairsRouter::reset(const EdgeTimeTable &times) {
+  const auto &edges = graph_.getEdges();
+  std::vector<int> from(edges.size()), to(edges.size());
+  for (std::size_t e = 0; e < edges.size(); ++e) {
+    from[e] = static_cast<int>(graph_.indexOfId(edges[e].getFromId()));
+    to[e] = static_cast<int>(graph_.indexOfId(edges[e].getToId()));
+  }
+  const EdgeTimes row = times.travelTimes(classIdx_);
+  weights_.assign(row.begin(), row.end());
+  epoch_ = times.epoch();
+  synced_ = true;
+
+  // Build inline so routes are available right away.
+  auto table = std::make_shared<AllPairsTable>(
+      AllPairsTable::build(graph_.getNodes().size(), from, to, weights_));
+  table->epoch = epoch_;
+
+  std::lock_guard lock(mutex_);
+  from_ = std::move(from);
+  to_ = std::move(to);
+  nodeCount_ = graph_.getNodes().size();
+  latestWeights_ = weights_;
+  latestEpoch_ = epoch_;
+  pending_.reset();
+  rebuildDue_ = false;
+  current_ = std::move(table);
+  misses_ = 0;
+  ++rebuilds_;
+}
+
+void AllPairsRouter::sync(const EdgeTimeTable &times) {
+  if (!synced_ || times.edgeCount() != weights_.size() ||
+      times.edgeCount() != graph_.getEdges().size()) {
+    reset(times);
+    return;
+  }
+
+  if (times.epoch() != epoch_) {
+    const EdgeTimes row = times.travelTimes(classIdx_);
+    diff_.clear();
+    if (times.epoch() == epoch_ + 1) {
+      for (const std::size_t e : times.changedEdges()) {
+        if (weights_[e] != row[e])
+          diff_.push_back(e);
+      }
+    } else {
+      for (std::size_t e = 0; e < weights_.size(); ++e) {
+        if (weights_[e] != row[e])
+          diff_.push_back(e);
+      }
+    }
+    bool onlyCheaper = diff_.size() <= kMaxPatchedEdges;
+    for (const std::size_t e : diff_) {
+      onlyCheaper = onlyCheaper && row[e] < weights_[e];
+      weights_[e] = row[e];
+    }
+    epoch_ = times.epoch();
+    if (!diff_.empty())
+      applyChanges(onlyCheaper);
+  }
+
+  bool due = false;
+  {
+    std::lock_guard lock(mutex_);
+    due = std::exchange(rebuildDue_, false);
+  }
+  if (due) {
+    auto table = std::make_shared<AllPairsTable>(
+        AllPairsTable::build(nodeCount_, from_, to_, weights_));
+    table->epoch = epoch_;
+    publish(std::move(table));
+  }
+}
+
+void AllPairsRouter::applyChanges(bool onlyCheaper) {
+  std::shared_ptr<const AllPairsTable> base;
+  std::uint64_t exactEpoch = 0;
+  {
+    std::lock_guard lock(mutex_);
+    base = current_;
+    exactEpoch = latestEpoch_;
+  }
+
+  // Patch only a table that was exact for the weights before this change.
+  if (onlyCheaper && base && base->epoch == exactEpoch) {
+    auto patched = std::make_shared<AllPairsTable>(*base);
+    for (const std::size_t e : diff_)
+      patched->lowerEdge(from_[e], to_[e], weights_[e]);
+    patched->epoch = epoch_;
+    std::lock_guard lock(mutex_);
+    latestWeights_ = weights_;
+    latestEpoch_ = epoch_;
+    current_ = std::move(patched);
+    ++patches_;
+    return;
+  }
+
+  // Otherwise the table goes stale; tryRoute() decides when to rebuild.
+  std::lock_guard lock(mutex_);
+  latestWeights_ = weights_;
+  latestEpoch_ = epoch_;
+}
+
+void AllPairsRouter::publish(std::shared_ptr<const AllPairsTable> table) {
+  std::lock_guard lock(mutex_);
+  if (current_ && current_->epoch >= table->epoch)
+    return;
+  current_ = std::move(table);
+  rebuildRequested_ = false;
+  misses_ = 0;
+  ++rebuilds_;
+}
+
+void AllPairsRouter::rebuildLoop() {
+  std::vector<int> from, to;
+  while (true) {
+    std::vector<double> weights;
+    std::uint64_t epoch = 0;
+    std::size_t n = 0;
+    {
+      std::lock_guard lock(mutex_);
+      if (!pending_ || stopping_) {
+        building_ = false;
+        return;
+      }
+      weights = std::move(*pending_);
+      epoch = pendingEpoch_;
+      pending_.reset();
+      // Copy the topology so a reset() on the simulation thread never races
+      // with the build.
+      from = from_;
+      to = to_;
+      n = nodeCount_;
+    }
+    if (from.size() != weights.size())
+      continue;
+    auto table = std::make_shared<AllPairsTable>(
+        AllPairsTable::build(n, from, to, weights));
+    table->epoch = epoch;
+    publish(std::move(table));
+  }
+}
+
+std::shared_ptr<const AllPairsTable> AllPairsRouter::table() const {
+  std::lock_guard lock(mutex_);
+  return current_;
+}
+
+std::optional<std::vector<int>> AllPairsRouter::tryRoute(int startId,
+                                                        int goalId) {
+  std::shared_ptr<const AllPairsTable> t;
+  bool launch = false;
+  {
+    std::lock_guard lock(mutex_);
+    t = current_;
+    if (!t || t->n != graph_.getNodes().size())
+      return std::nullopt;
+    if (t->epoch != latestEpoch_) {
+      // Stale: let the caller search, and rebuild once the searches add up
+      // to about the cost of one rebuild.
+      const std::size_t budget = std::max<std::size_t>(1, t->n * t->n / 128);
+      if (++misses_ >= budget && !rebuildRequested_) {
+        rebuildRequested_ = true;
+        if (builds_) {
+          pending_ = latestWeights_;
+          pendingEpoch_ = latestEpoch_;
+          launch = !std::exchange(building_, true);
+        } else {
+          rebuildDue_ = true;
+        }
+      }
+      t.reset();
+    }
+  }
+  if (launch)
+    builds_->run([this] { rebuildLoop(); });
+  if (!t)
+    return std::nullopt;
+
+  ++hits_;
+  if (!graph_.hasId(startId) || !graph_.hasId(goalId))
+    return std::vector<int>{};
+  std::vector<int> path =
+      t->pathIndices(static_cast<int>(graph_.indexOfId(startId)),
+                     static_cast<int>(graph_.indexOfId(goalId)));
+  for (int &v : path)
+    v = graph_.getNodes()[static_cast<std::size_t>(v)].getId();
+  return path;
+}
+
+std::uint64_t AllPairsRouter::rebuilds() const {
+  std::lock_guard lock(mutex_);
+  return rebuilds_;
+}
+
+std::uint64_t AllPairsRouter::patches() const {
+  std::lock_guard lock(mutex_);
+  return patches_;
+}
+
+std::uint64_t AllPairsRouter::hits() const { return hits_.load(); }
@@ -0,0 +1,121 @@
+#include "Easy_rider/RoutingStrategies/DestinationTreeCache.h"
+
+#include <algorithm>
+
+DestinationTreeCache::DestinationTreeCache(
+    const Graph<Intersection, Road> &graph, std::size_t classIdx,
+    std::size_t maxTrees, std::uint32_t minDemand)
+    : graph_(graph), classIdx_(classIdx),
+      maxTrees_(std::max<std::size_t>(1, maxTrees)),
+      minDemand_(std::max<std::uint32_t>(1, minDemand)) {}
+
+void DestinationTreeCache::sync(const EdgeTimeTable &times) {
+  std::lock_guard lock(mutex_);
+  if (synced_ && times.epoch() == epoch_ &&
+      weights_->size() == times.edgeCount())
+    return;
+
+  // Trees are regrown lazily: an entry is stale once grownAt != epoch_. A
+  // fresh copy, since trees may still be growing from the previous one.
+  const EdgeTimes row = times.travelTimes(classIdx_);
+  weights_ = std::make_shared<const std::vector<double>>(row.begin(),
+                                                         row.end());
+  epoch_ = times.epoch();
+  synced_ = true;
+}
+
+std::optional<std::vector<int>> DestinationTreeCache::tryRoute(int startId,
+                                                               int goalId) {
+  int goalIdx = -1;
+  std::shared_ptr<const ShortestPathTree> tree;
+  std::shared_ptr<ShortestPathTree> grown;
+  std::shared_ptr<const std::vector<double>> weights;
+  std::uint64_t epoch = 0;
+  {
+    std::unique_lock lock(mutex_);
+    if (!synced_ || weights_->size() != graph_.getEdges().size() ||
+        !graph_.hasId(startId) || !graph_.hasId(goalId))
+      return std::nullopt;
+
+    goalIdx = static_cast<int>(graph_.indexOfId(goalId));
+    Entry *entry = entryFor(goalIdx);
+    // Wait while another caller regrows this goal's tree for epoch_.
+    while (entry && entry->grownAt != epoch_ && entry->growing == epoch_) {
+      grown_.wait(lock);
+      auto it = entries_.find(goalIdx);
+      entry = it == entries_.end() ? nullptr : &it->second;
+    }
+    if (!entry)
+      return std::nullopt;
+
+    if (entry->grownAt == epoch_) {
+      tree = entry->tree;
+    } else {
+      // A fresh tree: readers may still be following the stale one.
+      entry->growing = epoch_;
+      entry->tree.reset();
+      grown = std::make_shared<ShortestPathTree>();
+      weights = weights_;
+      epoch = epoch_;
+    }
+    ++hits_;
+  }
+
+  if (grown) {
+    grown->growToward(graph_, *weights, goalIdx);
+    tree = grown;
+    {
+      std::lock_guard lock(mutex_);
+      ++rebuilds_;
+      // Publish unless the goal was evicted or the weights moved on.
+      auto it = entries_.find(goalIdx);
+      if (it != entries_.end() && it->second.growing == epoch) {
+        it->second.growing.reset();
+        if (epoch == epoch_) {
+          it->second.tree = std::move(grown);
+          it->second.grownAt = epoch;
+        }
+      }
+    }
+    grown_.notify_all();
+  }
+  return tree->pathIdsToRoot(static_cast<int>(graph_.indexOfId(startId)),
+                             graph_);
+}
+
+std::size_t DestinationTreeCache::cachedGoals() const {
+  std::lock_guard lock(mutex_);
+  return entries_.size();
+}
+
+std::uint64_t DestinationTreeCache::hits() const {
+  std::lock_guard lock(mutex_);
+  return hits_;
+}
+
+std::uint64_t DestinationTreeCache::rebuilds() const {
+  std::lock_guard lock(mutex_);
+  return rebuilds_;
+}
+
+DestinationTreeCache::Entry *DestinationTreeCache::entryFor(int goalIdx) {
+  auto it = entries_.find(goalIdx);
+  if (it == entries_.end()) {
+    if (++demand_[goalIdx] < minDemand_)
+      return nullptr;
+
+    // Replace the least recently used goal when full.
+    if (entries_.size() >= maxTrees_) {
+      auto node = entries_.extract(std::ranges::min_element(
+          entries_, {}, [](const auto &kv) { return kv.second.lastUsed; }));
+      node.key() = goalIdx;
+      node.mapped() = Entry{};
+      it = entries_.insert(std::move(node)).position;
+    } else {
+      it = entries_.emplace(goalIdx, Entry{}).first;
+    }
+  }
+
+  it->second.lastUsed = ++useClock_;
+  return &it->second;
+}
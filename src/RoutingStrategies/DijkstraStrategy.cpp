@@ -5,10 +5,10 @@
 #include <limits>
 #include <queue>
 
-std::vector<int>
-DijkstraStrategy::computeRoute(int startId, int goalId,
-                               const Graph<Intersection, Road> &graph) {
-  assert(timeFn_ && "timeFn must not be null");
+SearchResult
+DijkstraStrategy::search(int startId, int goalId,
+                         const Graph<Intersection, Road> &graph) const {
+  assert(times_ && "times must not be null");
 
   const auto &nodes = graph.getNodes();
   if (nodes.empty())
@@ -24,6 +24,9 @@ DijkstraStrategy::computeRoute(int startId, int goalId,
 
   const int n = static_cast<int>(nodes.size());
   const double INF = std::numeric_limits<double>::infinity();
+  const EdgeTimes weights = times_->travelTimes(classIdx_);
+  assert(weights.size() == graph.getEdges().size() &&
+         "edge time snapshot is out of date");
 
   std::vector<double> dist(n, INF);
   std::vector<int> parent(n, -1);
@@ -34,6 +37,7 @@ DijkstraStrategy::computeRoute(int startId, int goalId,
 
   dist[sIdx] = 0.0;
   pq.emplace(0.0, sIdx);
+  std::size_t settled = 0;
 
   while (!pq.empty()) {
     auto [du, uIdx] = pq.top();
@@ -41,16 +45,14 @@ DijkstraStrategy::computeRoute(int startId, int goalId,
     if (used[uIdx])
       continue;
     used[uIdx] = 1;
+    ++settled;
     if (uIdx == gIdx)
       break;
 
-    for (const auto &nbr : graph.outgoing(uIdx)) {
-      const int vIdx = nbr.first;
-      const Road &e = nbr.second;
-
-      const double w = timeFn_(e);
+    for (const auto &[vIdx, eIdx] : graph.outgoingIndices(uIdx)) {
+      const double w = weights[eIdx];
       assert(std::isfinite(w) && w >= 0.0 &&
-             "timeFn(edge) must be finite and >= 0");
+             "edge time must be finite and >= 0");
 
       const double nd = dist[uIdx] + w;
       if (nd < dist[vIdx]) {
@@ -61,5 +63,5 @@ DijkstraStrategy::computeRoute(int startId, int goalId,
     }
   }
 
-  return rebuildPathIdsFromParents(sIdx, gIdx, parent, graph);
+  return {rebuildPathIdsFromParents(sIdx, gIdx, parent, graph), settled};
 }
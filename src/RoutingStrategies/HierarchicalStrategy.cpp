@@ -0,0 +1,128 @@
+#include "Easy_rider/RoutingStrategies/HierarchicalStrategy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+SearchResult
+HierarchicalStrategy::search(int startId, int goalId,
+                             const Graph<Intersection, Road> &graph) const {
+  assert(times_ && "times must not be null");
+  SearchResult result;
+  if (!graph.hasId(startId) || !graph.hasId(goalId))
+    return result;
+
+  const int sIdx = static_cast<int>(graph.indexOfId(startId));
+  const int gIdx = static_cast<int>(graph.indexOfId(goalId));
+  // An unbounded radius admits every street: one plain bidirectional search.
+  if (std::isfinite(options_.localRadius))
+    result.route = searchLayer(sIdx, gIdx, graph, true, result.settled);
+  if (result.route.empty())
+    result.route = searchLayer(sIdx, gIdx, graph, false, result.settled);
+  return result;
+}
+
+std::vector<int>
+HierarchicalStrategy::searchLayer(int sIdx, int gIdx,
+                                  const Graph<Intersection, Road> &graph,
+                                  bool restrict, std::size_t &settled) const {
+  const auto &nodes = graph.getNodes();
+  const auto &edges = graph.getEdges();
+  const EdgeTimes weights = times_->travelTimes(classIdx_);
+  assert(weights.size() == edges.size() &&
+         "edge time snapshot is out of date");
+
+  if (sIdx == gIdx)
+    return rebuildPathIdsFromParents(sIdx, gIdx, {}, graph);
+
+  const auto &start = nodes[static_cast<std::size_t>(sIdx)];
+  const auto &goal = nodes[static_cast<std::size_t>(gIdx)];
+  const double r2 = options_.localRadius * options_.localRadius;
+  auto near = [&](int idx) {
+    const auto &p = nodes[static_cast<std::size_t>(idx)];
+    auto d2 = [&](const Intersection &q) {
+      const double dx = static_cast<double>(p.getX() - q.getX());
+      const double dy = static_cast<double>(p.getY() - q.getY());
+      return dx * dx + dy * dy;
+    };
+    return d2(start) <= r2 || d2(goal) <= r2;
+  };
+  auto allowed = [&](int uIdx, int vIdx, std::size_t eIdx) {
+    return !restrict || edges[eIdx].getRoadClass() != RoadClass::Street ||
+           near(uIdx) || near(vIdx);
+  };
+
+  const std::size_t n = nodes.size();
+  const double INF = std::numeric_limits<double>::infinity();
+  // Side 0 searches forward from the start, side 1 backward from the goal;
+  // link[1][v] is then the next node from v toward the goal.
+  std::vector<double> dist[2] = {std::vector<double>(n, INF),
+                                 std::vector<double>(n, INF)};
+  std::vector<int> link[2] = {std::vector<int>(n, -1),
+                              std::vector<int>(n, -1)};
+  std::vector<char> closed[2] = {std::vector<char>(n, 0),
+                                 std::vector<char>(n, 0)};
+
+  using QElem = std::pair<double, int>; // (dist, idx)
+  using Queue =
+      std::priority_queue<QElem, std::vector<QElem>, std::greater<>>;
+  Queue open[2];
+
+  dist[0][sIdx] = 0.0;
+  dist[1][gIdx] = 0.0;
+  open[0].emplace(0.0, sIdx);
+  open[1].emplace(0.0, gIdx);
+
+  double best = INF;
+  int meet = -1;
+  const double slack = 1.0 + std::max(0.0, options_.maxSuboptimality);
+
+  while (!open[0].empty() && !open[1].empty()) {
+    if (slack * (open[0].top().first + open[1].top().first) >= best)
+      break;
+
+    const int side = open[0].top().first <= open[1].top().first ? 0 : 1;
+    const auto [d, uIdx] = open[side].top();
+    open[side].pop();
+    if (closed[side][uIdx])
+      continue;
+    closed[side][uIdx] = 1;
+    ++settled;
+
+    const auto &adj =
+        side == 0 ? graph.outgoingIndices(uIdx) : graph.incomingIndices(uIdx);
+    for (const auto &[vIdx, eIdx] : adj) {
+      if (!(side == 0 ? allowed(uIdx, vIdx, eIdx)
+                      : allowed(vIdx, uIdx, eIdx)))
+        continue;
+      const double w = weights[eIdx];
+      assert(std::isfinite(w) && w >= 0.0 &&
+             "edge time must be finite and >= 0");
+
+      const double tentative = d + w;
+      if (tentative < dist[side][vIdx]) {
+        dist[side][vIdx] = tentative;
+        link[side][vIdx] = uIdx;
+        open[side].emplace(tentative, vIdx);
+      }
+      if (const double through = dist[side][vIdx] + dist[1 - side][vIdx];
+          through < best) {
+        best = through;
+        meet = vIdx;
+      }
+    }
+  }
+
+  if (meet < 0)
+    return {};
+
+  std::vector<int> ids;
+  for (int cur = meet; cur != -1; cur = link[0][cur])
+    ids.push_back(nodes[static_cast<std::size_t>(cur)].getId());
+  std::ranges::reverse(ids);
+  for (int cur = link[1][meet]; cur != -1; cur = link[1][cur])
+    ids.push_back(nodes[static_cast<std::size_t>(cur)].getId());
+  return ids;
+}
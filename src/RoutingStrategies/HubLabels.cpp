@@ -0,0 +1,621 @@
+/**
+ * @file HubLabels.cpp
+ * @brief Contraction ordering, pruned labelling and the flat file format.
+ */
+#include "Easy_rider/RoutingStrategies/HubLabels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+// Files are memory-mapped where POSIX mmap exists, and read into memory
+// elsewhere (e.g. Windows). Define HUB_LABELS_MMAP=0 to read them anyway.
+#ifndef HUB_LABELS_MMAP
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#define HUB_LABELS_MMAP 1
+#else
+#define HUB_LABELS_MMAP 0
+#endif
+#endif
+
+#if HUB_LABELS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct HubLabelIndex::Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t nodeCount;
+  std::uint64_t edgeCount;
+  std::uint64_t outCount; ///< Entries over all out-labels.
+  std::uint64_t inCount;  ///< Entries over all in-labels.
+  std::uint64_t graphHash;  ///< networkFingerprint() of the graph.
+  std::uint64_t weightHash; ///< weightFingerprint() of the weights.
+  double buildSeconds;
+};
+
+struct HubLabelIndex::Entry {
+  std::uint32_t hub;  ///< Hub rank (0 = most important).
+  std::uint32_t link; ///< Next node toward the hub, or kNoLink at the hub.
+  double dist;
+};
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'R', 'H', 'U', 'B', 'L', 'B', 'L'};
+constexpr std::uint32_t kVersion = 2;
+constexpr std::uint32_t kNoLink = std::numeric_limits<std::uint32_t>::max();
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+// Witness searches give up after this many settled nodes; a failed search
+// only adds a redundant shortcut, never a wrong one.
+constexpr std::size_t kWitnessSettleLimit = 64;
+
+// FNV-1a over the bytes of each value fed to it.
+class Fingerprint {
+public:
+  template <class T> void add(const T &value) {
+    const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      hash_ ^= bytes[i];
+      hash_ *= 0x100000001b3ull;
+    }
+  }
+  [[nodiscard]] std::uint64_t value() const { return hash_; }
+
+private:
+  std::uint64_t hash_{0xcbf29ce484222325ull};
+};
+
+// Node ids in index order and every edge's (from, to, length): the labels
+// refer to nodes by index, so both must match.
+std::uint64_t networkFingerprint(const Graph<Intersection, Road> &graph) {
+  Fingerprint f;
+  for (const auto &node : graph.getNodes())
+    f.add(node.getId());
+  for (const auto &edge : graph.getEdges()) {
+    f.add(edge.getFromId());
+    f.add(edge.getToId());
+    f.add(edge.getLength());
+  }
+  return f.value();
+}
+
+std::uint64_t weightFingerprint(EdgeTimes weights) {
+  Fingerprint f;
+  for (double w : weights)
+    f.add(w);
+  return f.value();
+}
+
+// Byte offsets of the sections of a block for n nodes.
+struct Layout {
+  std::size_t outOffsets, inOffsets, outEntries, inEntries, hubNode, bytes;
+};
+
+Layout layoutFor(std::size_t n, std::size_t outCount, std::size_t inCount,
+                 std::size_t headerBytes, std::size_t entryBytes) {
+  auto align8 = [](std::size_t x) { return (x + 7) & ~std::size_t{7}; };
+  Layout l{};
+  l.outOffsets = align8(headerBytes);
+  l.inOffsets = l.outOffsets + (n + 1) * sizeof(std::uint64_t);
+  l.outEntries = l.inOffsets + (n + 1) * sizeof(std::uint64_t);
+  l.inEntries = l.outEntries + outCount * entryBytes;
+  l.hubNode = l.inEntries + inCount * entryBytes;
+  l.bytes = align8(l.hubNode + n * sizeof(std::uint32_t));
+  return l;
+}
+
+/**
+ * Node order by simulated contraction: repeatedly contract the node whose
+ * removal adds the fewest shortcuts relative to the edges it removes.
+ * Returns the nodes from least to most important.
+ */
+std::vector<int> contractionOrder(const Graph<Intersection, Road> &graph,
+                                  EdgeTimes weights) {
+  const int n = static_cast<int>(graph.getNodes().size());
+  using Adj = std::vector<std::pair<int, double>>;
+  std::vector<Adj> out(n), in(n);
+  auto link = [](Adj &adj, int v, double w) {
+    for (auto &[u, x] : adj) {
+      if (u == v) {
+        x = std::min(x, w);
+        return;
+      }
+    }
+    adj.emplace_back(v, w);
+  };
+  for (int u = 0; u < n; ++u) {
+    for (const auto &[v, e] : graph.outgoingIndices(u)) {
+      link(out[u], v, weights[e]);
+      link(in[v], u, weights[e]);
+    }
+  }
+
+  std::vector<char> contracted(n, 0);
+  std::vector<int> deletedNeighbours(n, 0);
+
+  // Bounded Dijkstra from u avoiding `skip`; true if w is reached within
+  // `limit`.
+  std::vector<double> dist(n, INF);
+  std::vector<int> touched;
+  auto witness = [&](int u, int w, int skip, double limit) {
+    using QElem = std::pair<double, int>;
+    std::priority_queue<QElem, std::vector<QElem>, std::greater<>> open;
+    dist[u] = 0.0;
+    touched.push_back(u);
+    open.emplace(0.0, u);
+    bool found = false;
+    std::size_t settled = 0;
+    while (!open.empty() && settled < kWitnessSettleLimit) {
+      const auto [d, x] = open.top();
+      open.pop();
+      if (d > dist[x])
+        continue;
+      if (d > limit)
+        break;
+      if (x == w) {
+        found = true;
+        break;
+      }
+      ++settled;
+      for (const auto &[y, wt] : out[x]) {
+        if (y == skip || contracted[y] || d + wt >= dist[y])
+          continue;
+        if (dist[y] == INF)
+          touched.push_back(y);
+        dist[y] = d + wt;
+        open.emplace(dist[y], y);
+      }
+    }
+    for (int x : touched)
+      dist[x] = INF;
+    touched.clear();
+    return found;
+  };
+
+  // Contract v (or only count, if !apply); returns the shortcut count.
+  auto contract = [&](int v, bool apply) {
+    int shortcuts = 0;
+    for (const auto &[u, wu] : in[v]) {
+      if (contracted[u])
+        continue;
+      for (const auto &[w, ww] : out[v]) {
+        if (contracted[w] || w == u)
+          continue;
+        if (witness(u, w, v, wu + ww))
+          continue;
+        ++shortcuts;
+        if (apply) {
+          link(out[u], w, wu + ww);
+          link(in[w], u, wu + ww);
+        }
+      }
+    }
+    return shortcuts;
+  };
+  auto importance = [&](int v) {
+    int degree = 0;
+    for (const auto &[u, w] : in[v])
+      degree += contracted[u] ? 0 : 1;
+    for (const auto &[u, w] : out[v])
+      degree += contracted[u] ? 0 : 1;
+    return contract(v, false) - degree + deletedNeighbours[v];
+  };
+
+  using QElem = std::pair<int, int>; // (importance, node)
+  std::priority_queue<QElem, std::vector<QElem>, std::greater<>> queue;
+  for (int v = 0; v < n; ++v)
+    queue.emplace(importance(v), v);
+
+  std::vector<int> order;
+  order.reserve(n);
+  while (!queue.empty()) {
+    const auto [prio, v] = queue.top();
+    queue.pop();
+    if (contracted[v])
+      continue;
+    // Lazy update: re-evaluate and requeue if no longer the minimum.
+    const int now = importance(v);
+    if (!queue.empty() && now > queue.top().first) {
+      queue.emplace(now, v);
+      continue;
+    }
+    contract(v, true);
+    contracted[v] = 1;
+    order.push_back(v);
+    for (const auto &[u, w] : in[v])
+      ++deletedNeighbours[u];
+    for (const auto &[u, w] : out[v])
+      ++deletedNeighbours[u];
+  }
+  return order;
+}
+
+} // namespace
+
+HubLabelIndex HubLabelIndex::build(const Graph<Intersection, Road> &graph,
+                                   EdgeTimes weights) {
+  assert(weights.size() == graph.getEdges().size() &&
+         "weights must have one entry per edge");
+  const auto t0 = std::chrono::steady_clock::now();
+  const int n = static_cast<int>(graph.getNodes().size());
+
+  // Most important node first: its rank is 0.
+  std::vector<int> byRank = contractionOrder(graph, weights);
+  std::ranges::reverse(byRank);
+
+  std::vector<std::vector<Entry>> outLabels(n), inLabels(n);
+  std::vector<double> hubDist(n, INF); // By hub rank, for the root's label.
+  std::vector<double> dist(n, INF);
+  std::vector<int> parent(n, -1);
+  std::vector<int> touched;
+
+  // Pruned Dijkstra from the hub of rank r. Forward searches fill in-labels
+  // (hub reaches v); backward searches fill out-labels (v reaches hub).
+  auto prunedSearch = [&](std::uint32_t r, bool forward) {
+    const int root = byRank[r];
+    auto &rootLabels = forward ? outLabels : inLabels;
+    auto &labels = forward ? inLabels : outLabels;
+    for (const Entry &e : rootLabels[root])
+      hubDist[e.hub] = e.dist;
+
+    using QElem = std::pair<double, int>;
+    std::priority_queue<QElem, std::vector<QElem>, std::greater<>> open;
+    dist[root] = 0.0;
+    touched.push_back(root);
+    open.emplace(0.0, root);
+    while (!open.empty()) {
+      const auto [d, v] = open.top();
+      open.pop();
+      if (d > dist[v])
+        continue;
+      // Prune if hubs of higher rank already cover root <-> v.
+      bool covered = false;
+      for (const Entry &e : labels[v]) {
+        if (hubDist[e.hub] + e.dist <= d) {
+          covered = true;
+          break;
+        }
+      }
+      if (covered)
+        continue;
+      labels[v].push_back(Entry{r,
+                                parent[v] < 0
+                                    ? kNoLink
+                                    : static_cast<std::uint32_t>(parent[v]),
+                                d});
+
+      const auto &adj =
+          forward ? graph.outgoingIndices(v) : graph.incomingIndices(v);
+      for (const auto &[u, e] : adj) {
+        const double nd = d + weights[e];
+        if (nd >= dist[u])
+          continue;
+        if (dist[u] == INF)
+          touched.push_back(u);
+        dist[u] = nd;
+        parent[u] = v;
+        open.emplace(nd, u);
+      }
+    }
+
+    for (int v : touched) {
+      dist[v] = INF;
+      parent[v] = -1;
+    }
+    touched.clear();
+    for (const Entry &e : rootLabels[root])
+      hubDist[e.hub] = INF;
+  };
+
+  for (std::uint32_t r = 0; r < static_cast<std::uint32_t>(n); ++r) {
+    prunedSearch(r, true);
+    prunedSearch(r, false);
+  }
+
+  // Flatten into one block.
+  std::size_t outCount = 0, inCount = 0;
+  for (int v = 0; v < n; ++v) {
+    outCount += outLabels[v].size();
+    inCount += inLabels[v].size();
+  }
+  const Layout l =
+      layoutFor(n, outCount, inCount, sizeof(Header), sizeof(Entry));
+
+  HubLabelIndex index;
+  index.owned_.assign(l.bytes / sizeof(std::uint64_t), 0);
+  auto *block = reinterpret_cast<std::byte *>(index.owned_.data());
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.nodeCount = static_cast<std::uint32_t>(n);
+  header.edgeCount = graph.getEdges().size();
+  header.outCount = outCount;
+  header.inCount = inCount;
+  header.graphHash = networkFingerprint(graph);
+  header.weightHash = weightFingerprint(weights);
+  header.buildSeconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - t0)
+                            .count();
+  std::memcpy(block, &header, sizeof(header));
+
+  auto flatten = [&](const std::vector<std::vector<Entry>> &labels,
+                     std::size_t offsetsAt, std::size_t entriesAt) {
+    auto *offsets = reinterpret_cast<std::uint64_t *>(block + offsetsAt);
+    auto *entries = reinterpret_cast<Entry *>(block + entriesAt);
+    std::uint64_t at = 0;
+    for (int v = 0; v < n; ++v) {
+      offsets[v] = at;
+      std::ranges::copy(labels[v], entries + at);
+      at += labels[v].size();
+    }
+    offsets[n] = at;
+  };
+  flatten(outLabels, l.outOffsets, l.outEntries);
+  flatten(inLabels, l.inOffsets, l.inEntries);
+  auto *hubNode = reinterpret_cast<std::uint32_t *>(block + l.hubNode);
+  for (int r = 0; r < n; ++r)
+    hubNode[r] = static_cast<std::uint32_t>(byRank[r]);
+
+  index.bind(block);
+  return index;
+}
+
+std::optional<HubLabelIndex> HubLabelIndex::open(const std::string &path) {
+  HubLabelIndex index;
+#if HUB_LABELS_MMAP
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return std::nullopt;
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return std::nullopt;
+  }
+  const auto bytes = static_cast<std::size_t>(st.st_size);
+  void *map = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED)
+    return std::nullopt;
+  index.map_ = map;
+  index.mapBytes_ = bytes;
+  const auto *block = static_cast<const std::byte *>(map);
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    return std::nullopt;
+  const auto size = static_cast<std::streamoff>(file.tellg());
+  if (size < static_cast<std::streamoff>(sizeof(Header)))
+    return std::nullopt;
+  const auto bytes = static_cast<std::size_t>(size);
+  index.owned_.resize((bytes + 7) / sizeof(std::uint64_t));
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char *>(index.owned_.data()),
+                 static_cast<std::streamsize>(bytes)))
+    return std::nullopt;
+  const auto *block = reinterpret_cast<const std::byte *>(index.owned_.data());
+#endif
+
+  Header header{};
+  std::memcpy(&header, block, sizeof(header));
+  // Bound the counts first so the layout arithmetic cannot overflow.
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion ||
+      header.nodeCount > bytes / sizeof(std::uint32_t) ||
+      header.outCount > bytes / sizeof(Entry) ||
+      header.inCount > bytes / sizeof(Entry))
+    return std::nullopt; // ~HubLabelIndex releases the block.
+  const Layout l = layoutFor(header.nodeCount, header.outCount,
+                             header.inCount, sizeof(Header), sizeof(Entry));
+  if (l.bytes != bytes)
+    return std::nullopt;
+
+  index.bind(block);
+  if (!index.wellFormed())
+    return std::nullopt;
+  return index;
+}
+
+HubLabelIndex::HubLabelIndex(HubLabelIndex &&other) noexcept {
+  *this = std::move(other);
+}
+
+HubLabelIndex &HubLabelIndex::operator=(HubLabelIndex &&other) noexcept {
+  if (this == &other)
+    return *this;
+  unmap();
+  // Moving a vector keeps its buffer, so views into owned_ stay valid.
+  owned_ = std::move(other.owned_);
+  map_ = std::exchange(other.map_, nullptr);
+  mapBytes_ = std::exchange(other.mapBytes_, 0);
+  header_ = std::exchange(other.header_, nullptr);
+  outOffsets_ = std::exchange(other.outOffsets_, nullptr);
+  inOffsets_ = std::exchange(other.inOffsets_, nullptr);
+  outEntries_ = std::exchange(other.outEntries_, nullptr);
+  inEntries_ = std::exchange(other.inEntries_, nullptr);
+  hubNode_ = std::exchange(other.hubNode_, nullptr);
+  return *this;
+}
+
+HubLabelIndex::~HubLabelIndex() { unmap(); }
+
+void HubLabelIndex::unmap() noexcept {
+#if HUB_LABELS_MMAP
+  if (map_)
+    ::munmap(map_, mapBytes_);
+#endif
+  map_ = nullptr;
+  mapBytes_ = 0;
+}
+
+void HubLabelIndex::bind(const std::byte *block) {
+  header_ = reinterpret_cast<const Header *>(block);
+  const Layout l = layoutFor(header_->nodeCount, header_->outCount,
+                             header_->inCount, sizeof(Header), sizeof(Entry));
+  outOffsets_ = reinterpret_cast<const std::uint64_t *>(block + l.outOffsets);
+  inOffsets_ = reinterpret_cast<const std::uint64_t *>(block + l.inOffsets);
+  outEntries_ = reinterpret_cast<const Entry *>(block + l.outEntries);
+  inEntries_ = reinterpret_cast<const Entry *>(block + l.inEntries);
+  hubNode_ = reinterpret_cast<const std::uint32_t *>(block + l.hubNode);
+}
+
+bool HubLabelIndex::save(const std::string &path) const {
+  if (!header_)
+    return false;
+  const Layout l = layoutFor(header_->nodeCount, header_->outCount,
+                             header_->inCount, sizeof(Header), sizeof(Entry));
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(header_),
+             static_cast<std::streamsize>(l.bytes));
+  return static_cast<bool>(file);
+}
+
+bool HubLabelIndex::wellFormed() const {
+  const std::uint32_t n = header_->nodeCount;
+  auto labelsValid = [n](const std::uint64_t *offsets, const Entry *entries,
+                         std::uint64_t count) {
+    if (offsets[0] != 0 || offsets[n] != count)
+      return false;
+    for (std::uint32_t v = 0; v < n; ++v) {
+      if (offsets[v + 1] < offsets[v] || offsets[v + 1] > count)
+        return false;
+      for (std::uint64_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+        const Entry &e = entries[i];
+        if (e.hub >= n || (e.link >= n && e.link != kNoLink) ||
+            !(e.dist >= 0.0))
+          return false;
+        // Strictly increasing hubs: query() merges, find() bisects.
+        if (i > offsets[v] && entries[i - 1].hub >= e.hub)
+          return false;
+      }
+    }
+    return true;
+  };
+  if (!labelsValid(outOffsets_, outEntries_, header_->outCount) ||
+      !labelsValid(inOffsets_, inEntries_, header_->inCount))
+    return false;
+  return std::all_of(hubNode_, hubNode_ + n,
+                     [n](std::uint32_t v) { return v < n; });
+}
+
+bool HubLabelIndex::covers(const Graph<Intersection, Road> &graph) const {
+  return header_ && header_->nodeCount == graph.getNodes().size() &&
+         header_->edgeCount == graph.getEdges().size();
+}
+
+bool HubLabelIndex::matches(const Graph<Intersection, Road> &graph,
+                            EdgeTimes weights) const {
+  return covers(graph) && header_->graphHash == networkFingerprint(graph) &&
+         header_->weightHash == weightFingerprint(weights);
+}
+
+const HubLabelIndex::Entry *HubLabelIndex::find(const Entry *first,
+                                                const Entry *last,
+                                                std::uint32_t hub) {
+  const Entry *it = std::lower_bound(
+      first, last, hub, [](const Entry &e, std::uint32_t h) {
+        return e.hub < h;
+      });
+  return it != last && it->hub == hub ? it : nullptr;
+}
+
+std::pair<double, std::int64_t> HubLabelIndex::query(int sIdx,
+                                                     int gIdx) const {
+  const Entry *a = outEntries_ + outOffsets_[sIdx];
+  const Entry *aEnd = outEntries_ + outOffsets_[sIdx + 1];
+  const Entry *b = inEntries_ + inOffsets_[gIdx];
+  const Entry *bEnd = inEntries_ + inOffsets_[gIdx + 1];
+
+  double best = INF;
+  std::int64_t hub = -1;
+  while (a != aEnd && b != bEnd) {
+    if (a->hub < b->hub) {
+      ++a;
+    } else if (b->hub < a->hub) {
+      ++b;
+    } else {
+      if (a->dist + b->dist < best) {
+        best = a->dist + b->dist;
+        hub = a->hub;
+      }
+      ++a;
+      ++b;
+    }
+  }
+  return {best, hub};
+}
+
+double HubLabelIndex::distance(int sIdx, int gIdx) const {
+  if (!header_ || sIdx < 0 || gIdx < 0 ||
+      static_cast<std::uint32_t>(std::max(sIdx, gIdx)) >= header_->nodeCount)
+    return INF;
+  return query(sIdx, gIdx).first;
+}
+
+std::vector<int> HubLabelIndex::pathIndices(int sIdx, int gIdx) const {
+  if (!std::isfinite(distance(sIdx, gIdx)))
+    return {};
+  // distance() validated the indices; query again for the hub.
+  const auto hub = static_cast<std::uint32_t>(query(sIdx, gIdx).second);
+  const int hubIdx = static_cast<int>(hubNode_[hub]);
+
+  // Walk s -> hub along out-label links, then hub -> g backwards along
+  // in-label links. Every node on a pruned search's tree carries the hub;
+  // a broken or cyclic chain (a corrupt index) gives no path.
+  const std::size_t n = header_->nodeCount;
+  std::vector<int> path{sIdx};
+  for (int cur = sIdx; cur != hubIdx;) {
+    const Entry *e = find(outEntries_ + outOffsets_[cur],
+                          outEntries_ + outOffsets_[cur + 1], hub);
+    if (!e || e->link == kNoLink || path.size() > n)
+      return {};
+    cur = static_cast<int>(e->link);
+    path.push_back(cur);
+  }
+  std::vector<int> tail;
+  for (int cur = gIdx; cur != hubIdx;) {
+    tail.push_back(cur);
+    const Entry *e = find(inEntries_ + inOffsets_[cur],
+                          inEntries_ + inOffsets_[cur + 1], hub);
+    if (!e || e->link == kNoLink || path.size() + tail.size() > n)
+      return {};
+    cur = static_cast<int>(e->link);
+  }
+  path.insert(path.end(), tail.rbegin(), tail.rend());
+  return path;
+}
+
+HubLabelIndex::Stats HubLabelIndex::stats() const {
+  Stats s;
+  if (!header_)
+    return s;
+  s.nodes = header_->nodeCount;
+  s.outEntries = header_->outCount;
+  s.inEntries = header_->inCount;
+  for (std::size_t v = 0; v < s.nodes; ++v) {
+    s.maxLabel = std::max<std::size_t>(
+        {s.maxLabel, outOffsets_[v + 1] - outOffsets_[v],
+         inOffsets_[v + 1] - inOffsets_[v]});
+  }
+  s.avgLabel = s.nodes ? static_cast<double>(s.outEntries + s.inEntries) /
+                             static_cast<double>(2 * s.nodes)
+                       : 0.0;
+  s.bytes = layoutFor(s.nodes, s.outEntries, s.inEntries, sizeof(Header),
+                      sizeof(Entry))
+                .bytes;
+  s.buildSeconds = header_->buildSeconds;
+  return s;
+}
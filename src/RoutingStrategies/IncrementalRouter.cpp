@@ -0,0 +1,230 @@
+#include "Easy_rider/RoutingStrategies/IncrementalRouter.h"
+
+#include <algorithm>
+#include <functional>
+
+IncrementalRouter::IncrementalRouter(const Graph<Intersection, Road> &graph,
+                                     std::size_t classIdx,
+                                     std::size_t maxTrees)
+    : graph_(graph), classIdx_(classIdx),
+      maxTrees_(std::max<std::size_t>(1, maxTrees)) {}
+
+void IncrementalRouter::reset(const EdgeTimeTable &times) {
+  const EdgeTimes row = times.travelTimes(classIdx_);
+  weights_.assign(row.begin(), row.end());
+
+  const auto &edges = graph_.getEdges();
+  edgeFrom_.resize(edges.size());
+  for (std::size_t e = 0; e < edges.size(); ++e)
+    edgeFrom_[e] = static_cast<int>(graph_.indexOfId(edges[e].getFromId()));
+
+  nodeCount_ = graph_.getNodes().size();
+  trees_.clear();
+  epoch_ = times.epoch();
+  synced_ = true;
+}
+
+void IncrementalRouter::applyChanges(EdgeTimes row,
+                                     std::span<const std::size_t> edges) {
+  dirty_.clear();
+  for (const std::size_t e : edges) {
+    // A speed change may not move this class's time (e.g. below its cap).
+    if (weights_[e] == row[e])
+      continue;
+    weights_[e] = row[e];
+    dirty_.push_back(edgeFrom_[e]);
+  }
+  std::ranges::sort(dirty_);
+  const auto [first, last] = std::ranges::unique(dirty_);
+  dirty_.erase(first, last);
+}
+
+void IncrementalRouter::sync(const EdgeTimeTable &times) {
+  std::lock_guard lock(mutex_);
+  if (!synced_ || times.edgeCount() != graph_.getEdges().size() ||
+      weights_.size() != times.edgeCount() ||
+      nodeCount_ != graph_.getNodes().size()) {
+    reset(times);
+    return;
+  }
+  if (times.epoch() == epoch_)
+    return;
+
+  const EdgeTimes row = times.travelTimes(classIdx_);
+  if (times.epoch() == epoch_ + 1) {
+    applyChanges(row, times.changedEdges());
+  } else {
+    diff_.clear();
+    for (std::size_t e = 0; e < weights_.size(); ++e) {
+      if (weights_[e] != row[e])
+        diff_.push_back(e);
+    }
+    applyChanges(row, diff_);
+  }
+  epoch_ = times.epoch();
+
+  // Only rhs values move here; nodes are re-expanded by the next query.
+  for (auto &[goal, tree] : trees_) {
+    for (const int u : dirty_)
+      updateVertex(tree, u);
+  }
+}
+
+std::vector<int> IncrementalRouter::route(int startId, int goalId) {
+  std::lock_guard lock(mutex_);
+  if (!synced_ || nodeCount_ != graph_.getNodes().size() ||
+      !graph_.hasId(startId) || !graph_.hasId(goalId))
+    return {};
+
+  const int sIdx = static_cast<int>(graph_.indexOfId(startId));
+  const int gIdx = static_cast<int>(graph_.indexOfId(goalId));
+  GoalTree &tree = treeFor(gIdx);
+  tree.lastUsed = ++useClock_;
+
+  computeTo(tree, sIdx);
+  return extractPath(tree, sIdx);
+}
+
+std::size_t IncrementalRouter::cachedGoals() const {
+  std::lock_guard lock(mutex_);
+  return trees_.size();
+}
+
+std::uint64_t IncrementalRouter::expansions() const {
+  std::lock_guard lock(mutex_);
+  return expansions_;
+}
+
+IncrementalRouter::GoalTree &IncrementalRouter::treeFor(int goalIdx) {
+  if (const auto it = trees_.find(goalIdx); it != trees_.end())
+    return it->second;
+
+  // Reuse the buffers of the least recently used tree when full.
+  decltype(trees_)::iterator it;
+  if (trees_.size() >= maxTrees_) {
+    auto node = trees_.extract(std::ranges::min_element(
+        trees_, {}, [](const auto &kv) { return kv.second.lastUsed; }));
+    node.key() = goalIdx;
+    it = trees_.insert(std::move(node)).position;
+  } else {
+    it = trees_.emplace(goalIdx, GoalTree{}).first;
+  }
+
+  GoalTree &t = it->second;
+  t.goalIdx = goalIdx;
+  t.g.assign(nodeCount_, kInf);
+  t.rhs.assign(nodeCount_, kInf);
+  t.heap.clear();
+  t.rhs[static_cast<std::size_t>(goalIdx)] = 0.0;
+  push(t, goalIdx);
+  return t;
+}
+
+void IncrementalRouter::push(GoalTree &t, int idx) {
+  const auto i = static_cast<std::size_t>(idx);
+  t.heap.emplace_back(std::min(t.g[i], t.rhs[i]), idx);
+  std::ranges::push_heap(t.heap, std::greater<>{});
+
+  // Drop stale entries once they dominate the heap.
+  if (t.heap.size() > 4 * nodeCount_ + 64) {
+    std::erase_if(t.heap, [&](const auto &entry) {
+      const auto j = static_cast<std::size_t>(entry.second);
+      return t.g[j] == t.rhs[j] || entry.first != std::min(t.g[j], t.rhs[j]);
+    });
+    std::ranges::make_heap(t.heap, std::greater<>{});
+  }
+}
+
+void IncrementalRouter::updateVertex(GoalTree &t, int idx) {
+  const auto i = static_cast<std::size_t>(idx);
+  if (idx != t.goalIdx) {
+    double best = kInf;
+    for (const auto &[vIdx, eIdx] : graph_.outgoingIndices(idx)) {
+      const double c = weights_[eIdx] + t.g[static_cast<std::size_t>(vIdx)];
+      best = std::min(best, c);
+    }
+    t.rhs[i] = best;
+  }
+  if (t.g[i] != t.rhs[i])
+    push(t, idx);
+}
+
+void IncrementalRouter::computeTo(GoalTree &t, int startIdx) {
+  const auto s = static_cast<std::size_t>(startIdx);
+  auto &heap = t.heap;
+
+  while (true) {
+    // Skip entries of nodes that became consistent or were re-keyed.
+    while (!heap.empty()) {
+      const auto [key, idx] = heap.front();
+      const auto i = static_cast<std::size_t>(idx);
+      if (t.g[i] != t.rhs[i] && key == std::min(t.g[i], t.rhs[i]))
+        break;
+      std::ranges::pop_heap(heap, std::greater<>{});
+      heap.pop_back();
+    }
+    if (heap.empty())
+      break;
+    if (heap.front().first >= std::min(t.g[s], t.rhs[s]) &&
+        t.g[s] == t.rhs[s])
+      break;
+
+    std::ranges::pop_heap(heap, std::greater<>{});
+    const int uIdx = heap.back().second;
+    heap.pop_back();
+    ++expansions_;
+
+    const auto u = static_cast<std::size_t>(uIdx);
+    if (t.g[u] > t.rhs[u]) {
+      // Overconsistent: distance dropped; predecessors may improve.
+      t.g[u] = t.rhs[u];
+      for (const auto &[pIdx, eIdx] : graph_.incomingIndices(uIdx)) {
+        if (pIdx == t.goalIdx)
+          continue;
+        const auto p = static_cast<std::size_t>(pIdx);
+        const double cand = weights_[eIdx] + t.g[u];
+        if (cand < t.rhs[p]) {
+          t.rhs[p] = cand;
+          if (t.g[p] != t.rhs[p])
+            push(t, pIdx);
+        }
+      }
+    } else {
+      // Underconsistent: distance rose; re-derive u and its predecessors.
+      t.g[u] = kInf;
+      updateVertex(t, uIdx);
+      for (const auto &[pIdx, eIdx] : graph_.incomingIndices(uIdx))
+        updateVertex(t, pIdx);
+    }
+  }
+}
+
+std::vector<int> IncrementalRouter::extractPath(const GoalTree &t,
+                                                int startIdx) const {
+  const auto &nodes = graph_.getNodes();
+  if (t.g[static_cast<std::size_t>(startIdx)] == kInf)
+    return {};
+
+  std::vector<int> ids;
+  int cur = startIdx;
+  ids.push_back(nodes[static_cast<std::size_t>(cur)].getId());
+  while (cur != t.goalIdx) {
+    if (ids.size() > nodeCount_)
+      return {}; // Defensive: never loop on inconsistent state.
+
+    int next = -1;
+    double best = kInf;
+    for (const auto &[vIdx, eIdx] : graph_.outgoingIndices(cur)) {
+      const double c = weights_[eIdx] + t.g[static_cast<std::size_t>(vIdx)];
+      if (c < best) {
+        best = c;
+        next = vIdx;
+      }
+    }
+    if (next < 0)
+      return {};
+    cur = next;
+    ids.push_back(nodes[static_cast<std::size_t>(cur)].getId());
+  }
+  return ids;
+}
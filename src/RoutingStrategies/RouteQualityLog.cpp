@@ -0,0 +1,52 @@
+#include "Easy_rider/RoutingStrategies/RouteQualityLog.h"
+
+#include <algorithm>
+
+void RouteQualityLog::setSampleEvery(std::size_t sampleEvery) {
+  std::lock_guard lock(mutex_);
+  sampleEvery_ = sampleEvery;
+}
+
+bool RouteQualityLog::recordSearch(std::size_t settled) {
+  std::lock_guard lock(mutex_);
+  ++searches_;
+  settled_ += settled;
+  return sampleEvery_ != 0 && searches_ % sampleEvery_ == 0;
+}
+
+void RouteQualityLog::recordSample(double cost, double optimalCost,
+                                   std::size_t settled,
+                                   std::size_t optimalSettled) {
+  const double costRatio = optimalCost > 0.0 ? cost / optimalCost : 1.0;
+  const double settledRatio =
+      optimalSettled ? static_cast<double>(settled) /
+                           static_cast<double>(optimalSettled)
+                     : 1.0;
+  std::lock_guard lock(mutex_);
+  ++samples_;
+  costRatioSum_ += costRatio;
+  costRatioMax_ = std::max(costRatioMax_, costRatio);
+  settledRatioSum_ += settledRatio;
+}
+
+RouteQualityLog::Stats RouteQualityLog::stats() const {
+  std::lock_guard lock(mutex_);
+  Stats s;
+  s.searches = searches_;
+  s.settled = settled_;
+  s.samples = samples_;
+  if (samples_) {
+    const auto n = static_cast<double>(samples_);
+    s.meanCostRatio = costRatioSum_ / n;
+    s.maxCostRatio = costRatioMax_;
+    s.meanSettledRatio = settledRatioSum_ / n;
+  }
+  return s;
+}
+
+void RouteQualityLog::reset() {
+  std::lock_guard lock(mutex_);
+  searches_ = settled_ = samples_ = 0;
+  costRatioSum_ = settledRatioSum_ = 0.0;
+  costRatioMax_ = 1.0;
+}
@@ -0,0 +1,117 @@
+#include "Easy_rider/RoutingStrategies/ShortestPathTree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+void ShortestPathTree::reset(std::size_t n) {
+  if (dist_.size() != n) {
+    dist_.assign(n, kInf);
+    parent_.assign(n, -1);
+    settled_.assign(n, 0);
+    targetStamp_.assign(n, 0);
+    touched_.clear();
+    return;
+  }
+  for (const int idx : touched_) {
+    const auto i = static_cast<std::size_t>(idx);
+    dist_[i] = kInf;
+    parent_[i] = -1;
+    settled_[i] = 0;
+  }
+  touched_.clear();
+}
+
+void ShortestPathTree::grow(const Graph<Intersection, Road> &graph,
+                            EdgeTimes weights, int rootIdx,
+                            std::span<const int> stopAt) {
+  search<false>(graph, weights, rootIdx, stopAt);
+}
+
+void ShortestPathTree::growToward(const Graph<Intersection, Road> &graph,
+                                  EdgeTimes weights, int rootIdx) {
+  search<true>(graph, weights, rootIdx, {});
+}
+
+std::vector<int>
+ShortestPathTree::pathIdsToRoot(int startIdx,
+                                const Graph<Intersection, Road> &graph) const {
+  std::vector<int> ids;
+  if (startIdx < 0 || static_cast<std::size_t>(startIdx) >= dist_.size() ||
+      dist_[static_cast<std::size_t>(startIdx)] == kInf)
+    return ids;
+
+  const auto &nodes = graph.getNodes();
+  for (int cur = startIdx; cur != -1;
+       cur = parent_[static_cast<std::size_t>(cur)])
+    ids.push_back(nodes[static_cast<std::size_t>(cur)].getId());
+  return ids;
+}
+
+template <bool Reverse>
+void ShortestPathTree::search(const Graph<Intersection, Road> &graph,
+                              EdgeTimes weights, int rootIdx,
+                              std::span<const int> stopAt) {
+  const std::size_t n = graph.getNodes().size();
+  assert(weights.size() == graph.getEdges().size() &&
+         "edge time snapshot is out of date");
+  reset(n);
+  root_ = rootIdx;
+  if (rootIdx < 0 || static_cast<std::size_t>(rootIdx) >= n)
+    return;
+
+  // Mark targets with a fresh stamp so we never have to clear the array.
+  if (++stamp_ == 0) {
+    std::ranges::fill(targetStamp_, 0u);
+    stamp_ = 1;
+  }
+  std::size_t remaining = 0;
+  for (const int t : stopAt) {
+    if (t < 0 || static_cast<std::size_t>(t) >= n)
+      continue;
+    auto &mark = targetStamp_[static_cast<std::size_t>(t)];
+    if (mark != stamp_) {
+      mark = stamp_;
+      ++remaining;
+    }
+  }
+  const bool stopEarly = !stopAt.empty();
+
+  heap_.clear();
+  dist_[static_cast<std::size_t>(rootIdx)] = 0.0;
+  touched_.push_back(rootIdx);
+  heap_.emplace_back(0.0, rootIdx);
+
+  while (!heap_.empty()) {
+    std::ranges::pop_heap(heap_, std::greater<>{});
+    const auto [du, uIdx] = heap_.back();
+    heap_.pop_back();
+
+    const auto u = static_cast<std::size_t>(uIdx);
+    if (settled_[u])
+      continue;
+    settled_[u] = 1;
+
+    if (stopEarly && targetStamp_[u] == stamp_ && --remaining == 0)
+      break;
+
+    const auto &adjacent = Reverse ? graph.incomingIndices(uIdx)
+                                   : graph.outgoingIndices(uIdx);
+    for (const auto &[vIdx, eIdx] : adjacent) {
+      const double w = weights[eIdx];
+      assert(std::isfinite(w) && w >= 0.0 &&
+             "edge time must be finite and >= 0");
+
+      const auto v = static_cast<std::size_t>(vIdx);
+      const double nd = du + w;
+      if (nd < dist_[v]) {
+        if (dist_[v] == kInf)
+          touched_.push_back(vIdx);
+        dist_[v] = nd;
+        parent_[v] = uIdx;
+        heap_.emplace_back(nd, vIdx);
+        std::ranges::push_heap(heap_, std::greater<>{});
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+#include "Easy_rider/RoutingStrategies/StrategyTable.h"
+#include "Easy_rider/Congestion/LoadForecast.h"
+#include "Easy_rider/RoutingStrategies/AStarStrategy.h"
+#include "Easy_rider/RoutingStrategies/AdaptiveStrategy.h"
+#include "Easy_rider/RoutingStrategies/AllPairsStrategy.h"
+#include "Easy_rider/RoutingStrategies/DestinationTreeStrategy.h"
+#include "Easy_rider/RoutingStrategies/DijkstraStrategy.h"
+#include "Easy_rider/RoutingStrategies/HubLabelStrategy.h"
+#include "Easy_rider/RoutingStrategies/IncrementalStrategy.h"
+#include "Easy_rider/RoutingStrategies/TimeDependentStrategy.h"
+
+#include <cassert>
+#include <utility>
+
+StrategyTable::StrategyTable(Sources sources, StrategyAlgoritm active)
+    : active_(active) {
+  reset(std::move(sources));
+}
+
+void StrategyTable::reset(Sources sources) {
+  assert(sources.times && "StrategyTable needs an edge time snapshot");
+  sources_ = std::move(sources);
+  for (std::size_t a = 0; a < kStrategyAlgoritmCount; ++a)
+    engines_[a] = composeStrategy(static_cast<StrategyAlgoritm>(a), sources_);
+}
+
+std::unique_ptr<RouteStrategy>
+composeStrategy(StrategyAlgoritm algo, const StrategyTable::Sources &s) {
+  assert(s.times && "composeStrategy needs an edge time snapshot");
+  if (s.hubLabels)
+    return std::make_unique<HubLabelStrategy>(s.hubLabels);
+
+  std::unique_ptr<RouteStrategy> search;
+  bool timeDependent = false;
+  switch (algo) {
+  case StrategyAlgoritm::AStar:
+  case StrategyAlgoritm::Dijkstra:
+    timeDependent = s.forecast != nullptr;
+    if (timeDependent)
+      search = std::make_unique<TimeDependentStrategy>(
+          *s.times, *s.forecast, s.classIdx,
+          algo == StrategyAlgoritm::AStar);
+    else if (algo == StrategyAlgoritm::AStar)
+      search = std::make_unique<AStarStrategy>(*s.times, s.classIdx,
+                                               s.astarWeight, s.quality);
+    else
+      search = std::make_unique<DijkstraStrategy>(*s.times, s.classIdx);
+    break;
+  case StrategyAlgoritm::Incremental:
+    if (s.incremental)
+      search = std::make_unique<IncrementalStrategy>(*s.incremental);
+    else
+      search = std::make_unique<DijkstraStrategy>(*s.times, s.classIdx);
+    break;
+  case StrategyAlgoritm::Hierarchical:
+    search = std::make_unique<HierarchicalStrategy>(*s.times, s.classIdx,
+                                                    s.hierarchy);
+    break;
+  case StrategyAlgoritm::Adaptive:
+    if (s.adaptive)
+      search = std::make_unique<AdaptiveStrategy>(*s.adaptive, *s.times);
+    else
+      search = std::make_unique<AStarStrategy>(*s.times, s.classIdx,
+                                               s.astarWeight, s.quality);
+    break;
+  }
+
+  // Incremental routing already keeps per-goal trees of its own, the
+  // adaptive router consults table and cache itself, and forecast-priced
+  // routes depend on the departure time.
+  const bool plainSearch = (algo == StrategyAlgoritm::AStar ||
+                            algo == StrategyAlgoritm::Dijkstra) &&
+                           !timeDependent;
+  if (s.allPairs && plainSearch)
+    return std::make_unique<AllPairsStrategy>(*s.allPairs, std::move(search));
+  if (s.cache && algo != StrategyAlgoritm::Incremental &&
+      algo != StrategyAlgoritm::Adaptive && !timeDependent)
+    return std::make_unique<DestinationTreeStrategy>(*s.cache,
+                                                     std::move(search));
+  return search;
+}
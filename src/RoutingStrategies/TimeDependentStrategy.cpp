@@ -0,0 +1,86 @@
+#include "Easy_rider/RoutingStrategies/TimeDependentStrategy.h"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+std::vector<int>
+TimeDependentStrategy::computeRoute(int startId, int goalId,
+                                    const Graph<Intersection, Road> &graph) {
+  assert(times_ && forecast_ && "times and forecast must not be null");
+
+  const auto &nodes = graph.getNodes();
+  if (nodes.empty() || !graph.hasId(startId) || !graph.hasId(goalId))
+    return {};
+
+  const int sIdx = static_cast<int>(graph.indexOfId(startId));
+  const int gIdx = static_cast<int>(graph.indexOfId(goalId));
+
+  const int n = static_cast<int>(nodes.size());
+  const double INF = std::numeric_limits<double>::infinity();
+  const EdgeTimes snapshot = times_->travelTimes(classIdx_);
+  assert(snapshot.size() == graph.getEdges().size() &&
+         "edge time snapshot is out of date");
+
+  const int cap = times_->classSpeedCap(classIdx_);
+  const double depart = forecast_->now();
+
+  // Edge time when entering edge e at absolute time t.
+  auto edgeTime = [&](std::size_t e, double t) -> double {
+    const auto load = forecast_->load(e, t);
+    if (!load)
+      return snapshot[e];
+    const double v = CongestionModel::speedForLoad(times_->freeSpeed(e),
+                                                   times_->capacity(e), *load);
+    return CongestionModel::travelTime(times_->length(e), v, cap);
+  };
+
+  const double vBound =
+      std::min(static_cast<double>(std::max(1, cap)), times_->maxFreeSpeed());
+  const auto &goal = nodes[static_cast<std::size_t>(gIdx)];
+  auto h = [&](int uIdx) -> double {
+    if (!goalDirected_ || vBound <= 0.0)
+      return 0.0;
+    const auto &u = nodes[static_cast<std::size_t>(uIdx)];
+    const double dx = static_cast<double>(u.getX() - goal.getX());
+    const double dy = static_cast<double>(u.getY() - goal.getY());
+    return std::hypot(dx, dy) / vBound;
+  };
+
+  std::vector<double> arrival(n, INF); // relative to depart
+  std::vector<int> parent(n, -1);
+  std::vector<char> closed(n, 0);
+
+  using QElem = std::pair<double, int>; // (arrival + h, idx)
+  std::priority_queue<QElem, std::vector<QElem>, std::greater<>> open;
+
+  arrival[sIdx] = 0.0;
+  open.emplace(h(sIdx), sIdx);
+
+  while (!open.empty()) {
+    auto [f, uIdx] = open.top();
+    open.pop();
+    if (closed[uIdx])
+      continue;
+    closed[uIdx] = 1;
+    if (uIdx == gIdx)
+      break;
+
+    const double tu = arrival[uIdx];
+    for (const auto &[vIdx, eIdx] : graph.outgoingIndices(uIdx)) {
+      const double w = edgeTime(eIdx, depart + tu);
+      assert(std::isfinite(w) && w >= 0.0 &&
+             "edge time must be finite and >= 0");
+
+      const double tv = tu + w;
+      if (tv < arrival[vIdx]) {
+        arrival[vIdx] = tv;
+        parent[vIdx] = uIdx;
+        open.emplace(tv + h(vIdx), vIdx);
+      }
+    }
+  }
+
+  return rebuildPathIdsFromParents(sIdx, gIdx, parent, graph);
+}
@@ -0,0 +1,71 @@
+#include "Easy_rider/RoutingStrategies/TravelTimeMatrix.h"
+
+#include "Easy_rider/RoutingStrategies/ShortestPathTree.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+TravelTimeMatrix
+computeTravelTimeMatrix(const Graph<Intersection, Road> &graph,
+                        EdgeTimes weights, const std::vector<int> &sources,
+                        const std::vector<int> &targets,
+                        TaskScheduler *scheduler) {
+  TravelTimeMatrix out;
+  out.sources = sources;
+  out.targets = targets;
+  out.times.assign(sources.size() * targets.size(),
+                   std::numeric_limits<double>::infinity());
+  if (sources.empty() || targets.empty())
+    return out;
+
+  auto toIdx = [&](int id) {
+    return graph.hasId(id) ? static_cast<int>(graph.indexOfId(id)) : -1;
+  };
+
+  std::vector<int> targetIdx;
+  targetIdx.reserve(targets.size());
+  for (const int id : targets)
+    targetIdx.push_back(toIdx(id));
+
+  // Search each distinct source once; duplicate rows are copied afterwards.
+  std::vector<int> uniqueSrc;
+  std::vector<std::size_t> firstRow(sources.size());
+  std::unordered_map<int, std::size_t> rowOf;
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    const auto [it, inserted] = rowOf.try_emplace(sources[i], i);
+    firstRow[i] = it->second;
+    if (inserted)
+      uniqueSrc.push_back(static_cast<int>(i));
+  }
+
+  const std::size_t cols = targets.size();
+  PerWorker<ShortestPathTree> trees;
+  trees.fit(scheduler);
+
+  auto search = [&](std::size_t worker, std::size_t k) {
+    const auto row = static_cast<std::size_t>(uniqueSrc[k]);
+    const int sIdx = toIdx(sources[row]);
+    if (sIdx < 0)
+      return;
+    auto &tree = trees[worker];
+    tree.grow(graph, weights, sIdx, targetIdx);
+    double *dst = out.times.data() + row * cols;
+    for (std::size_t j = 0; j < cols; ++j) {
+      if (targetIdx[j] >= 0)
+        dst[j] = tree.distance(targetIdx[j]);
+    }
+  };
+  if (scheduler)
+    scheduler->parallelFor(uniqueSrc.size(), search);
+  else
+    for (std::size_t k = 0; k < uniqueSrc.size(); ++k)
+      search(0, k);
+
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    if (firstRow[i] != i)
+      std::copy_n(out.times.begin() + firstRow[i] * cols, cols,
+                  out.times.begin() + i * cols);
+  }
+  return out;
+}
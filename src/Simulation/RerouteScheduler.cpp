@@ -0,0 +1,43 @@
+#include "Easy_rider/Simulation/RerouteScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+void RerouteScheduler::run(VehicleStore &vehicles) {
+  candidates_.clear();
+  for (Vehicle &v : vehicles) {
+    if (v.wantsReroute())
+      candidates_.emplace_back(v.distanceToNextNode(), &v);
+  }
+
+  std::size_t limit = candidates_.size();
+  if (budget_.maxPerTick > 0)
+    limit = std::min(limit, budget_.maxPerTick);
+
+  // Only the first `limit` entries need to be ordered.
+  auto byUrgency = [](const auto &a, const auto &b) {
+    return a.first < b.first;
+  };
+  if (limit < candidates_.size()) {
+    std::nth_element(candidates_.begin(), candidates_.begin() + limit,
+                     candidates_.end(), byUrgency);
+  }
+  std::sort(candidates_.begin(), candidates_.begin() + limit, byUrgency);
+
+  using clock = std::chrono::steady_clock;
+  const auto t0 = clock::now();
+  std::size_t started = 0;
+  while (started < limit) {
+    candidates_[started].second->recomputeRouteIfNeeded();
+    ++started;
+    if (budget_.maxMillis > 0.0 &&
+        std::chrono::duration<double, std::milli>(clock::now() - t0).count() >=
+            budget_.maxMillis)
+      break;
+  }
+
+  lastDispatched_ = started;
+  totalDispatched_ += started;
+  lastDeferred_ = candidates_.size() - started;
+  totalDeferred_ += lastDeferred_;
+}
@@ -0,0 +1,68 @@
+#include "Easy_rider/Simulation/RerouteService.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+RerouteService::RerouteService(const Graph<Intersection, Road> &graph,
+                               TaskScheduler &scheduler, unsigned maxTasks)
+    : graph_(graph), maxTasks_(std::max(1u, maxTasks)), tasks_(scheduler) {}
+
+RerouteService::~RerouteService() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+    queue_.clear();
+  }
+  tasks_.wait();
+}
+
+void RerouteService::submit(RerouteRequest request) {
+  bool start = false;
+  {
+    std::lock_guard lock(mutex_);
+    queue_.push_back(std::move(request));
+    ++inFlight_;
+    start = running_ < maxTasks_;
+    if (start)
+      ++running_;
+  }
+  if (start)
+    tasks_.run([this] { drainQueue(); });
+}
+
+void RerouteService::drainCompleted(std::vector<RerouteResult> &out) {
+  std::lock_guard lock(mutex_);
+  if (done_.empty())
+    return;
+  std::move(done_.begin(), done_.end(), std::back_inserter(out));
+  done_.clear();
+}
+
+std::size_t RerouteService::inFlight() const {
+  std::lock_guard lock(mutex_);
+  return inFlight_;
+}
+
+void RerouteService::drainQueue() {
+  while (true) {
+    RerouteRequest req;
+    {
+      std::lock_guard lock(mutex_);
+      if (queue_.empty() || stopping_) {
+        --running_;
+        return;
+      }
+      req = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    RerouteResult res{req.vehicle, req.startId,
+                      composeStrategy(req.algo, req.sources)
+                          ->computeRoute(req.startId, req.goalId, graph_)};
+
+    std::lock_guard lock(mutex_);
+    done_.push_back(std::move(res));
+    --inFlight_;
+  }
+}
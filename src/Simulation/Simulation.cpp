@@ -3,209 +3,453 @@
 #include "Easy_rider/Congestion/CongestionModel.h"
 #include "Easy_rider/Parameters/Parameters.h"
 #include "Easy_rider/RoutingStrategies/RouteStrategy.h"
+#include "Easy_rider/RoutingStrategies/ShortestPathTree.h"
 #include "Easy_rider/Vehicles/Car.h"
-#include "Easy_rider/Vehicles/IDM.h"
 #include "Easy_rider/Vehicles/Truck.h"
 #include "Easy_rider/Vehicles/Vehicle.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <numeric>
 #include <optional>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace {
 
-// Map key: directed edge -> ordered list of (progress, vehicle*)
-using Lanes =
-    std::unordered_map<EdgeKey, std::vector<std::pair<double, Vehicle *>>,
-                       EdgeKeyHash>;
-
-/**
- * @brief Resolve a Road* for a directed edge (fromId -> toId).
- * @return Pointer to Road or nullptr if not found.
- */
-const Road *findEdge(const Graph<Intersection, Road> &graph,
-                     const EdgeKey &key) {
-  try {
-    const int u = static_cast<int>(graph.indexOfId(key.first));
-    const int v = static_cast<int>(graph.indexOfId(key.second));
-    for (const auto &nbr : graph.outgoing(u)) {
-      if (nbr.first == v) {
-        return &nbr.second.get();
-      }
+// Handle to a member that outlives every engine composed from it.
+template <class T> std::shared_ptr<const T> unowned(const T &member) {
+  return {std::shared_ptr<const T>{}, &member};
+}
+
+} // namespace
+
+Simulation::Simulation(Graph<Intersection, Road> graph)
+    : scheduler_(Parameters::simulationThreads(), Parameters::pinThreads()),
+      graph_(std::move(graph)),
+      edgeTimes_({static_cast<int>(Car::kIDMParams.v0),
+                  static_cast<int>(Truck::kIDMParams.v0)}) {
+  static_assert(kVehicleClassCount == 2,
+                "edgeTimes_ needs one speed cap per VehicleClass");
+  lastStrategy_ = configuredStrategy();
+  vehicles_.setScheduler(&scheduler_);
+  edgeTimes_.rebuild(graph_, congestion_);
+  if (Parameters::timeDependentRouting())
+    forecast_ = std::make_unique<LoadForecast>(
+        graph_, edgeTimes_, Parameters::forecastBucketSeconds(),
+        Parameters::forecastHorizonBuckets());
+  const bool allPairs =
+      Parameters::allPairsTable() &&
+      graph_.getNodes().size() <= Parameters::allPairsMaxNodes();
+  for (std::size_t c = 0; c < kVehicleClassCount; ++c) {
+    incrementalRouters_[c] = std::make_unique<IncrementalRouter>(graph_, c);
+    incrementalRouters_[c]->sync(edgeTimes_);
+    if (allPairs) {
+      // The table answers every goal, so no destination cache is needed.
+      allPairsRouters_[c] = std::make_unique<AllPairsRouter>(
+          graph_, c, Parameters::asyncRerouting() ? &scheduler_ : nullptr);
+      allPairsRouters_[c]->sync(edgeTimes_);
+    } else if (Parameters::destinationTreeCache()) {
+      destinationCaches_[c] = std::make_unique<DestinationTreeCache>(
+          graph_, c, Parameters::destinationCacheSize(),
+          Parameters::destinationCacheMinDemand());
+      destinationCaches_[c]->sync(edgeTimes_);
     }
-  } catch (...) {
-    // fallthrough
+    adaptiveRouters_[c] = std::make_unique<AdaptiveRouter>(
+        graph_, c, allPairsRouters_[c].get(), destinationCaches_[c].get(),
+        HierarchyOptions{Parameters::hierarchyLocalRadius(),
+                         Parameters::hierarchySuboptimality()});
+    strategyTables_[c] =
+        std::make_unique<StrategyTable>(strategySources(c), lastStrategy_);
   }
-  return nullptr;
-}
-
-/**
- * @brief Shared implementation for spawning vehicle types.
- * @tparam T Concrete Vehicle type (Car, Truck, ...).
- */
-template <typename T>
-int spawnVehicleOf(std::vector<std::unique_ptr<Vehicle>> &vehicles,
-                   Graph<Intersection, Road> &graph,
-                   CongestionModel &congestion, int startId, int goalId,
-                   StrategyAlgoritm algo, std::size_t &rerouteCount,
-                   double &rerouteSavedTime) {
-  auto veh = std::make_unique<T>(graph, &congestion);
-  const int id = static_cast<int>(vehicles.size());
-  vehicles.emplace_back(std::move(veh));
-
-  vehicles[static_cast<std::size_t>(id)]->setStrategy(algo);
-  vehicles[static_cast<std::size_t>(id)]->setOnRerouteApplied(
-      [&rerouteCount, &rerouteSavedTime](int /*vehId*/, double oldETA,
-                                         double newETA) {
-        ++rerouteCount;
-        if (oldETA > newETA)
-          rerouteSavedTime += (oldETA - newETA);
-      });
+  onRerouteApplied_ = [this](int /*vehId*/, double oldETA, double newETA) {
+    ++rerouteCount_;
+    if (oldETA > newETA)
+      rerouteSavedTime_ += (oldETA - newETA);
+  };
+  rerouteRequester_ = [this](Vehicle &veh, int startId, int goalId) {
+    requestReroute(veh, startId, goalId);
+  };
+  rerouteScheduler_.setBudget({Parameters::rerouteBudgetPerTick(),
+                               Parameters::rerouteBudgetMs()});
+  if (Parameters::asyncRerouting())
+    rerouter_ = std::make_unique<RerouteService>(
+        graph_, scheduler_, Parameters::rerouteWorkers());
+}
+
+Simulation::~Simulation() = default;
 
-  return id;
+StrategyTable::Sources Simulation::strategySources(std::size_t cls) {
+  return {unowned(edgeTimes_),
+          cls,
+          incrementalRouters_[cls].get(),
+          adaptiveRouters_[cls].get(),
+          allPairsRouters_[cls].get(),
+          destinationCaches_[cls].get(),
+          forecast_ ? unowned(forecast_->table()) : nullptr,
+          {Parameters::hierarchyLocalRadius(),
+           Parameters::hierarchySuboptimality()},
+          astarWeight_,
+          &routeQuality_,
+          hubLabels_[cls]};
 }
 
-} // namespace
+std::size_t Simulation::adoptVehicle(VehicleClass cls,
+                                     StrategyAlgoritm algo) {
+  const std::size_t slot = vehicles_.size();
+  Vehicle &v = vehicles_.emplace(graph_, &congestion_, &edgeTimes_, cls);
+  ++spawnCount_;
 
-Simulation::~Simulation() = default;
+  v.setStrategyTable(strategyTables_[static_cast<std::size_t>(cls)].get());
+  v.setLoadForecast(forecast_.get());
+  v.setStrategy(algo);
+  v.setOnRerouteApplied(&onRerouteApplied_);
+  if (rerouter_)
+    v.setRerouteRequester(&rerouteRequester_);
+
+  return slot;
+}
+
+void Simulation::requestReroute(Vehicle &veh, int startId, int goalId) {
+  // Share one immutable copy of the snapshot per epoch. A fresh copy every
+  // time: a worker may still be reading the previous one after dropping its
+  // reference, so that buffer is never written again.
+  if (!sharedTimes_ || sharedTimes_->epoch() != edgeTimes_.epoch())
+    sharedTimes_ = std::make_shared<EdgeTimeTable>(edgeTimes_);
+  // The forecast changes with every route, so it is shared once per tick.
+  if (forecast_ && sharedForecastAt_ != simTime_) {
+    sharedForecast_ = std::make_shared<ForecastTable>(forecast_->table());
+    sharedForecastAt_ = simTime_;
+  }
+  // The class's sources, with the live snapshot and forecast swapped for
+  // the shared copies.
+  StrategyTable::Sources sources =
+      strategyTables_[static_cast<std::size_t>(veh.vehicleClass())]
+          ->sources();
+  sources.times = sharedTimes_;
+  if (sources.forecast)
+    sources.forecast = sharedForecast_;
+  rerouter_->submit(RerouteRequest{veh.handle(), startId, goalId,
+                                   veh.strategyAlgorithm(),
+                                   std::move(sources)});
+}
+
+void Simulation::applyCompletedReroutes() {
+  rerouteResults_.clear();
+  rerouter_->drainCompleted(rerouteResults_);
+  for (const auto &r : rerouteResults_) {
+    // Vehicles removed while their search ran have a stale handle.
+    if (Vehicle *v = vehicles_.find(r.vehicle))
+      v->applyReroute(r.startId, r.route);
+  }
+}
 
 void Simulation::update(double dt) {
   if (!running_ || paused_)
     return;
 
-  const double simSpeed = Parameters::simulationSpeed();
-  const double step = dt * simSpeed;
-  simTime_ += step;
+  simTime_ += dt;
 
   // Sync live strategy with Parameters.
-  const bool wantDijkstra = Parameters::isDijkstra();
-  if (wantDijkstra != (lastStrategy_ == StrategyAlgoritm::Dijkstra)) {
-    lastStrategy_ =
-        wantDijkstra ? StrategyAlgoritm::Dijkstra : StrategyAlgoritm::AStar;
+  if (Parameters::astarWeight() != astarWeight_) {
+    astarWeight_ = Parameters::astarWeight();
+    for (std::size_t c = 0; c < kVehicleClassCount; ++c)
+      strategyTables_[c]->reset(strategySources(c));
+    // Quality figures describe one weight; start over.
+    routeQuality_.reset();
     setStrategyForAll(lastStrategy_);
   }
-
-  // Build per-edge ordered lists (vehicles sorted by progress on each edge).
-  Lanes lanes;
-  lanes.reserve(vehicles_.size());
-  for (auto &up : vehicles_) {
-    Vehicle *v = up.get();
-    const auto edge = v->currentEdge();
-    if (edge.first < 0)
-      continue; // at node or no route
-    lanes[edge].emplace_back(v->edgeProgress(), v);
+  if (const auto wanted = configuredStrategy(); wanted != lastStrategy_) {
+    lastStrategy_ = wanted;
+    setStrategyForAll(lastStrategy_);
   }
 
-  // Sort by progress along each edge (rear -> front).
-  for (auto &[key, vec] : lanes) {
-    std::sort(vec.begin(), vec.end(),
-              [](const auto &a, const auto &b) { return a.first < b.first; });
+  // Snapshot edge speeds/times once; every query in this tick reads it.
+  edgeTimes_.rebuild(graph_, congestion_);
+  if (forecast_)
+    forecast_->advanceTo(simTime_);
+  for (auto &router : incrementalRouters_)
+    router->sync(edgeTimes_);
+  for (auto &cache : destinationCaches_) {
+    if (cache)
+      cache->sync(edgeTimes_);
+  }
+  for (auto &apsp : allPairsRouters_) {
+    if (apsp)
+      apsp->sync(edgeTimes_);
   }
 
-  // Feed leader info to vehicles for IDM.
-  for (auto &[key, vec] : lanes) {
-    const Road *edgePtr = findEdge(graph_, key);
-    if (!edgePtr) {
-      continue;
-    }
+  // Reroutes finished by the workers take effect at each vehicle's next node.
+  if (rerouter_)
+    applyCompletedReroutes();
 
-    for (std::size_t i = 0; i < vec.size(); ++i) {
-      Vehicle *me = vec[i].second;
-      me->clearLeaderInfo();
-
-      LeaderInfo li{};
-      if (i + 1 < vec.size()) {
-        // Leader exists on the same edge ahead of me.
-        Vehicle *lead = vec[i + 1].second;
-        li.present = true;
-        li.gap = std::max(0.0, lead->edgeProgress() - me->edgeProgress());
-        li.leaderSpeed = lead->currentSpeed();
-      } else {
-        // Open road: distance to the end of the edge.
-        li.present = false;
-        li.gap = std::max(0.0, edgePtr->getLength() - me->edgeProgress());
-        li.leaderSpeed = 0.0;
-      }
-      me->setLeaderInfo(li);
-    }
+  vehicles_.setMesoscopic(Parameters::mesoscopic(),
+                          {Parameters::mesoStorageFactor(),
+                           Parameters::mesoExitHeadway(),
+                           Parameters::mesoStuckTime()});
+  if (vehicles_.mesoscopic()) {
+    // Only the vehicles due to leave their edge in this step are touched.
+    vehicles_.advanceMesoscopic(dt);
+  } else {
+    // Leaders come from the persistent lanes; then one pass over the flat
+    // kinematic arrays advances every vehicle.
+    vehicles_.updateLeaders(edgeTimes_);
+    vehicles_.advance(dt, edgeTimes_);
   }
 
-  // Advance all vehicles.
-  for (auto &up : vehicles_)
-    up->update(step);
+  // Start the most urgent reroutes within this tick's budget.
+  rerouteScheduler_.run(vehicles_);
 
   pruneArrivedVehicles();
 
   if (onPostUpdate_)
-    onPostUpdate_(step);
+    onPostUpdate_(dt);
+}
+
+std::size_t Simulation::advanceFrame(double seconds) {
+  if (!running_ || paused_)
+    return 0;
+  const double step = Parameters::physicsDt();
+  if (step <= 0.0)
+    return 0;
+
+  accumulator_ += std::max(0.0, seconds) * Parameters::simulationSpeed();
+  const auto due = static_cast<std::size_t>(accumulator_ / step);
+  const std::size_t steps =
+      std::min<std::size_t>(due, Parameters::maxSubsteps());
+  for (std::size_t i = 0; i < steps; ++i) {
+    if (i + 1 == steps) {
+      prevFrame_ = snapshot();
+      std::ranges::sort(prevFrame_, {}, &SimSnapshotItem::id);
+    }
+    update(step);
+  }
+  // Drop what the step cap left over, but keep the fraction of a step.
+  accumulator_ = steps < due ? std::fmod(accumulator_, step)
+                             : accumulator_ - static_cast<double>(steps) * step;
+  alpha_ = std::clamp(accumulator_ / step, 0.0, 1.0);
+  return steps;
 }
 
 int Simulation::spawnVehicleCar(int startId, int goalId,
                                 StrategyAlgoritm algo) {
-  const int id =
-      spawnVehicleOf<Car>(vehicles_, graph_, congestion_, startId, goalId, algo,
-                          rerouteCount_, rerouteSavedTime_);
-  ensureInitialRoutes(id, startId, goalId);
-  return id;
+  const std::size_t slot = adoptVehicle(Car::kClass, algo);
+  ensureInitialRoutes(slot, startId, goalId);
+  return vehicles_[slot].id();
 }
 
 int Simulation::spawnVehicleTruck(int startId, int goalId,
                                   StrategyAlgoritm algo) {
-  const int id =
-      spawnVehicleOf<Truck>(vehicles_, graph_, congestion_, startId, goalId,
-                            algo, rerouteCount_, rerouteSavedTime_);
-  ensureInitialRoutes(id, startId, goalId);
-  return id;
+  const std::size_t slot = adoptVehicle(Truck::kClass, algo);
+  ensureInitialRoutes(slot, startId, goalId);
+  return vehicles_[slot].id();
+}
+
+std::vector<int>
+Simulation::spawnVehicles(const std::vector<SpawnRequest> &requests,
+                          StrategyAlgoritm algo) {
+  // Group requests by (class, origin): one search per group.
+  std::vector<std::size_t> order(requests.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::ranges::stable_sort(order, [&](std::size_t a, std::size_t b) {
+    const auto &ra = requests[a];
+    const auto &rb = requests[b];
+    return std::pair{ra.cls, ra.startId} < std::pair{rb.cls, rb.startId};
+  });
+
+  std::vector<std::size_t> groupBegin;
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    const auto &r = requests[order[k]];
+    if (k == 0 || r.cls != requests[order[k - 1]].cls ||
+        r.startId != requests[order[k - 1]].startId)
+      groupBegin.push_back(k);
+  }
+  groupBegin.push_back(order.size());
+
+  auto toIdx = [&](int id) {
+    return graph_.hasId(id) ? static_cast<int>(graph_.indexOfId(id)) : -1;
+  };
+
+  // The shared tree yields the routes of exact A* and Dijkstra. Hub labels
+  // and the other algorithms are left to the class's engine.
+  const bool exactSearch =
+      algo == StrategyAlgoritm::Dijkstra ||
+      (algo == StrategyAlgoritm::AStar && astarWeight_ <= 1.0);
+  auto sharesTree = [&](VehicleClass cls) {
+    return exactSearch && !hubLabels_[static_cast<std::size_t>(cls)];
+  };
+
+  spawnTrees_.fit(&scheduler_);
+  std::vector<std::vector<int>> routes(requests.size());
+
+  // Forecast-priced routes depend on the vehicles routed before them, so
+  // they are computed one by one below instead.
+  scheduler_.parallelFor(
+      forecast_ ? 0 : groupBegin.size() - 1,
+      [&](std::size_t worker, std::size_t g) {
+        const std::size_t begin = groupBegin[g];
+        const std::size_t end = groupBegin[g + 1];
+        const auto &first = requests[order[begin]];
+        const int sIdx = toIdx(first.startId);
+        if (sIdx < 0)
+          return;
+
+        if (!sharesTree(first.cls)) {
+          RouteStrategy &engine =
+              strategyTables_[static_cast<std::size_t>(first.cls)]->get(algo);
+          for (std::size_t k = begin; k < end; ++k)
+            routes[order[k]] = engine.computeRoute(
+                first.startId, requests[order[k]].goalId, graph_);
+          return;
+        }
+
+        // Small networks: walk the all-pairs table instead of searching.
+        if (auto *apsp =
+                allPairsRouters_[static_cast<std::size_t>(first.cls)].get()) {
+          bool answered = true;
+          for (std::size_t k = begin; k < end && answered; ++k) {
+            auto route = apsp->tryRoute(first.startId,
+                                        requests[order[k]].goalId);
+            answered = route.has_value();
+            if (answered)
+              routes[order[k]] = std::move(*route);
+          }
+          if (answered)
+            return;
+        }
+
+        std::vector<int> goals;
+        goals.reserve(end - begin);
+        for (std::size_t k = begin; k < end; ++k)
+          goals.push_back(toIdx(requests[order[k]].goalId));
+
+        auto &tree = spawnTrees_[worker];
+        tree.grow(graph_,
+                  edgeTimes_.travelTimes(static_cast<std::size_t>(first.cls)),
+                  sIdx, goals);
+        for (std::size_t k = begin; k < end; ++k) {
+          if (goals[k - begin] >= 0)
+            routes[order[k]] = tree.pathIds(goals[k - begin], graph_);
+        }
+      });
+
+  std::vector<int> ids;
+  ids.reserve(requests.size());
+  vehicles_.reserve(vehicles_.size() + requests.size());
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    const std::size_t slot = adoptVehicle(requests[i].cls, algo);
+    if (forecast_)
+      ensureInitialRoutes(slot, requests[i].startId, requests[i].goalId);
+    else
+      vehicles_[slot].setRoute(routes[i]);
+    ids.push_back(vehicles_[slot].id());
+  }
+  return ids;
+}
+
+StrategyAlgoritm Simulation::configuredStrategy() {
+  if (Parameters::incrementalRouting())
+    return StrategyAlgoritm::Incremental;
+  if (Parameters::hierarchicalRouting())
+    return StrategyAlgoritm::Hierarchical;
+  if (Parameters::adaptiveRouting())
+    return StrategyAlgoritm::Adaptive;
+  return Parameters::isDijkstra() ? StrategyAlgoritm::Dijkstra
+                                  : StrategyAlgoritm::AStar;
 }
 
 void Simulation::setStrategyForAll(StrategyAlgoritm algo) {
-  for (auto &v : vehicles_)
-    v->setStrategy(algo);
+  for (auto &table : strategyTables_)
+    table->setActive(algo);
+}
+
+void Simulation::setHubLabels(VehicleClass cls,
+                              std::shared_ptr<const HubLabelIndex> labels) {
+  const auto c = static_cast<std::size_t>(cls);
+  hubLabels_[c] = std::move(labels);
+  strategyTables_[c]->reset(strategySources(c));
+  // Re-plan the class with the new engines.
+  strategyTables_[c]->setActive(strategyTables_[c]->active());
 }
 
-void Simulation::ensureInitialRoutes(int vehIdx, int startId, int goalId) {
-  assert(vehIdx >= 0 && static_cast<std::size_t>(vehIdx) < vehicles_.size());
-  auto &veh = vehicles_[static_cast<std::size_t>(vehIdx)];
-  const auto route = veh->strategy()->computeRoute(startId, goalId, graph_);
-  veh->setRoute(route);
+std::shared_ptr<const HubLabelIndex>
+Simulation::loadOrBuildHubLabels(VehicleClass cls, const std::string &path) {
+  std::shared_ptr<const HubLabelIndex> labels;
+  const auto weights = edgeTimes_.freeFlowTimes(static_cast<std::size_t>(cls));
+  auto opened = HubLabelIndex::open(path);
+  if (opened && opened->matches(graph_, weights))
+    labels = std::make_shared<const HubLabelIndex>(std::move(*opened));
+  if (!labels) {
+    auto built = HubLabelIndex::build(graph_, weights);
+    built.save(path); // Best effort: the labels work without the file.
+    labels = std::make_shared<const HubLabelIndex>(std::move(built));
+  }
+  setHubLabels(cls, labels);
+  return labels;
+}
+
+TravelTimeMatrix Simulation::travelTimeMatrix(const std::vector<int> &sources,
+                                              const std::vector<int> &targets,
+                                              VehicleClass cls) const {
+  return computeTravelTimeMatrix(
+      graph_, edgeTimes_.travelTimes(static_cast<std::size_t>(cls)), sources,
+      targets, &scheduler_);
+}
+
+void Simulation::ensureInitialRoutes(std::size_t slot, int startId,
+                                     int goalId) {
+  assert(slot < vehicles_.size());
+  Vehicle &veh = vehicles_[slot];
+  const auto route = veh.strategy()->computeRoute(startId, goalId, graph_);
+  veh.setRoute(route);
 }
 
 std::vector<Simulation::SimSnapshotItem> Simulation::snapshot() const {
   std::vector<SimSnapshotItem> out;
   out.reserve(vehicles_.size());
-  int idx = 0;
-  for (const auto &ptr : vehicles_) {
-    if (auto rs = ptr->renderState()) {
-      out.emplace_back(SimSnapshotItem{idx, rs->fromId, rs->toId, rs->sOnEdge,
-                                       rs->currentSpeed});
+  for (const Vehicle &v : vehicles_) {
+    if (auto rs = v.renderState()) {
+      out.emplace_back(SimSnapshotItem{v.id(), rs->fromId, rs->toId,
+                                       rs->sOnEdge, rs->currentSpeed});
     }
-    ++idx;
+  }
+  return out;
+}
+
+std::vector<Simulation::SimSnapshotItem>
+Simulation::interpolatedSnapshot() const {
+  std::vector<SimSnapshotItem> out = snapshot();
+  if (prevFrame_.empty())
+    return out;
+  const double a = alpha_;
+  for (auto &item : out) {
+    const auto it = std::ranges::lower_bound(prevFrame_, item.id, {},
+                                             &SimSnapshotItem::id);
+    if (it == prevFrame_.end() || it->id != item.id ||
+        it->fromId != item.fromId || it->toId != item.toId)
+      continue;
+    item.sOnEdge = it->sOnEdge + a * (item.sOnEdge - it->sOnEdge);
+    item.currentSpeed = it->currentSpeed + a * (item.currentSpeed -
+                                                 it->currentSpeed);
   }
   return out;
 }
 
 double Simulation::getSimTime() const noexcept { return simTime_; }
 
-void Simulation::pruneArrivedVehicles() {
-  vehicles_.erase(std::remove_if(vehicles_.begin(), vehicles_.end(),
-                                 [](const std::unique_ptr<Vehicle> &v) {
-                                   return v->hasArrived();
-                                 }),
-                  vehicles_.end());
-}
+void Simulation::pruneArrivedVehicles() { vehicles_.eraseArrived(); }
 
 double Simulation::averageSpeed() const noexcept {
   double sum = 0.0;
   std::size_t count = 0;
 
-  for (const auto &up : vehicles_) {
-    if (up->renderState()) {
-      sum += up->currentSpeed();
+  for (const Vehicle &v : vehicles_) {
+    if (v.renderState()) {
+      sum += v.currentSpeed();
       ++count;
     }
   }
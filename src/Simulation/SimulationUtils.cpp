@@ -61,10 +61,7 @@ FleetManager::FleetManager(Simulation &sim, const std::vector<int> &nodeIds,
                            int targetCars, int targetTrucks, uint32_t seed)
     : sim_(sim), nodeIds_(nodeIds), targetCars_(targetCars),
       targetTrucks_(targetTrucks), rng_(seed) {
-  if (Parameters::isDijkstra())
-    alg_ = StrategyAlgoritm::Dijkstra;
-  else
-    alg_ = StrategyAlgoritm::AStar;
+  alg_ = Simulation::configuredStrategy();
   assert(nodeIds_.size() >= 2 && "Needs 2 Intersection at least.");
 }
 
@@ -86,50 +83,38 @@ std::pair<int, int> FleetManager::randomDistinctPair() {
   return {a, b};
 }
 
-void FleetManager::spawnOneCar() {
-  auto [s, g] = randomDistinctPair();
-  if (s < 0)
-    return;
-  sim_.spawnVehicleCar(s, g, alg_);
-}
-
-void FleetManager::spawnOneTruck() {
-  auto [s, g] = randomDistinctPair();
-  if (s < 0)
-    return;
-  sim_.spawnVehicleTruck(s, g, alg_);
+void FleetManager::appendRandomRequests(
+    std::vector<Simulation::SpawnRequest> &batch, VehicleClass cls,
+    int count) {
+  for (int i = 0; i < count; ++i) {
+    auto [s, g] = randomDistinctPair();
+    if (s < 0)
+      continue;
+    batch.push_back({s, g, cls});
+  }
 }
 
 void FleetManager::seedInitial() {
-  for (int i = 0; i < targetCars_; ++i)
-    spawnOneCar();
-  for (int i = 0; i < targetTrucks_; ++i)
-    spawnOneTruck();
+  std::vector<Simulation::SpawnRequest> batch;
+  batch.reserve(static_cast<std::size_t>(std::max(0, targetCars_) +
+                                         std::max(0, targetTrucks_)));
+  appendRandomRequests(batch, VehicleClass::Car, targetCars_);
+  appendRandomRequests(batch, VehicleClass::Truck, targetTrucks_);
+  sim_.spawnVehicles(batch, alg_);
 }
 
 void FleetManager::topUpIfNeeded() {
-  int cars = 0, trucks = 0;
-
-  const auto &vec = sim_.vehicles();
-  for (const auto &up : vec) {
-    if (!up)
-      continue;
-    if (up->renderState()) {
-      if (dynamic_cast<const Truck *>(up.get()))
-        ++trucks;
-      else
-        ++cars; // everything that isn't a Truck is a Car
-    }
-  }
-
-  while (cars < targetCars_) {
-    spawnOneCar();
-    ++cars;
-  }
-  while (trucks < targetTrucks_) {
-    spawnOneTruck();
-    ++trucks;
-  }
+  // Arrived vehicles are removed at the end of each update, so the store's
+  // per-class counts are the vehicles still driving.
+  const auto &store = sim_.vehicles();
+  const int cars = static_cast<int>(store.count(Car::kClass));
+  const int trucks = static_cast<int>(store.count(Truck::kClass));
+
+  std::vector<Simulation::SpawnRequest> batch;
+  appendRandomRequests(batch, VehicleClass::Car, targetCars_ - cars);
+  appendRandomRequests(batch, VehicleClass::Truck, targetTrucks_ - trucks);
+  if (!batch.empty())
+    sim_.spawnVehicles(batch, alg_);
 }
 
 } // namespace SimulationUtils
@@ -13,10 +13,11 @@ Road::Road(const Intersection &from, const Intersection &to, int maxSpeed)
     : Road(from, to, maxSpeed, kDefaultCapacityVehicles) {}
 
 Road::Road(const Intersection &from, const Intersection &to, int maxSpeed,
-           int capacityVehicles)
+           int capacityVehicles, RoadClass roadClass)
     : fromId_(from.getId()), toId_(to.getId()),
       length_(computeLength(from.getPosition(), to.getPosition())),
-      maxSpeed_(maxSpeed), capacityVehicles_(std::max(1, capacityVehicles)) {
+      maxSpeed_(maxSpeed), capacityVehicles_(std::max(1, capacityVehicles)),
+      roadClass_(roadClass) {
   assert(from.getId() != to.getId() && "Self-loop roads are not allowed");
 }
 
@@ -25,6 +26,7 @@ int Road::getToId() const { return toId_; }
 double Road::getLength() const { return length_; }
 int Road::getMaxSpeed() const { return maxSpeed_; }
 int Road::getCapacityVehicles() const { return capacityVehicles_; }
+RoadClass Road::getRoadClass() const { return roadClass_; }
 
 double Road::computeLength(const std::pair<int, int> &a,
                            const std::pair<int, int> &b) {
@@ -0,0 +1,64 @@
+/**
+ * @file EdgeLanes.cpp
+ * @brief Per-edge vehicle queues linked by store slot.
+ */
+#include "Easy_rider/Vehicles/EdgeLanes.h"
+
+#include <cassert>
+
+void EdgeLanes::enter(std::size_t edgeIdx, std::uint32_t slot) {
+  assert(ahead_[slot] == kNone && behind_[slot] == kNone &&
+         "Slot is already queued");
+  if (edgeIdx >= lanes_.size())
+    lanes_.resize(edgeIdx + 1);
+  Lane &lane = lanes_[edgeIdx];
+  ahead_[slot] = lane.back;
+  if (lane.back != kNone)
+    behind_[lane.back] = slot;
+  else
+    lane.front = slot;
+  lane.back = slot;
+  ++lane.count;
+}
+
+void EdgeLanes::leave(std::size_t edgeIdx, std::uint32_t slot) {
+  if (edgeIdx >= lanes_.size())
+    return;
+  Lane &lane = lanes_[edgeIdx];
+  const std::uint32_t ahead = ahead_[slot];
+  const std::uint32_t behind = behind_[slot];
+  if (ahead == kNone && lane.front != slot)
+    return;
+  if (ahead != kNone)
+    behind_[ahead] = behind;
+  else
+    lane.front = behind;
+  if (behind != kNone)
+    ahead_[behind] = ahead;
+  else
+    lane.back = ahead;
+  ahead_[slot] = kNone;
+  behind_[slot] = kNone;
+  --lane.count;
+}
+
+void EdgeLanes::relocate(std::size_t edgeIdx, std::uint32_t from,
+                         std::uint32_t to) {
+  const std::uint32_t ahead = ahead_[from];
+  const std::uint32_t behind = behind_[from];
+  ahead_[to] = ahead;
+  behind_[to] = behind;
+  ahead_[from] = kNone;
+  behind_[from] = kNone;
+  if (edgeIdx >= lanes_.size())
+    return;
+  Lane &lane = lanes_[edgeIdx];
+  if (ahead != kNone)
+    behind_[ahead] = to;
+  else if (lane.front == from)
+    lane.front = to;
+  if (behind != kNone)
+    ahead_[behind] = to;
+  else if (lane.back == from)
+    lane.back = to;
+}
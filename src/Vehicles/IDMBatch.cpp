@@ -0,0 +1,102 @@
+/**
+ * @file IDMBatch.cpp
+ * @brief Batched IDM kernel with an AVX2 path and a scalar fallback.
+ */
+#include "Easy_rider/Vehicles/IDMBatch.h"
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template <int Delta>
+void scalarBatch(const IDMParams &p, std::size_t first, std::size_t n,
+                 const double *v, const double *v0, const double *gap,
+                 const double *dv, double *out) {
+  for (std::size_t i = first; i < n; ++i)
+    out[i] = idm_accel_int<Delta>(v[i], v0[i], gap[i], dv[i], p);
+}
+
+#if defined(__AVX2__)
+template <int N> __m256d ipow4(__m256d x) {
+  if constexpr (N == 1)
+    return x;
+  else if constexpr (N % 2 == 0)
+    return ipow4<N / 2>(_mm256_mul_pd(x, x));
+  else
+    return _mm256_mul_pd(x, ipow4<N - 1>(x));
+}
+
+// Four lanes of idm_accel_int<Delta>, operation for operation, so every lane
+// rounds exactly like the scalar code. max_pd(x, c) is x > c ? x : c, the
+// same as std::max(c, x), NaN and signed zero included.
+template <int Delta>
+std::size_t avx2Batch(const IDMParams &p, std::size_t n, const double *v,
+                      const double *v0, const double *gap, const double *dv,
+                      double *out) {
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d floor = _mm256_set1_pd(1e-3);
+  const __m256d a = _mm256_set1_pd(p.a);
+  const __m256d T = _mm256_set1_pd(p.T);
+  const __m256d s0 = _mm256_set1_pd(p.s0);
+  const __m256d denom =
+      _mm256_set1_pd(2.0 * std::sqrt(std::max(1e-9, p.a * p.b)));
+
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256d vv = _mm256_max_pd(_mm256_loadu_pd(v + i), zero);
+    const __m256d v0c = _mm256_max_pd(_mm256_loadu_pd(v0 + i), floor);
+    const __m256d termFree = ipow4<Delta>(_mm256_div_pd(vv, v0c));
+    const __m256d dyn = _mm256_add_pd(
+        _mm256_mul_pd(vv, T),
+        _mm256_div_pd(_mm256_mul_pd(vv, _mm256_loadu_pd(dv + i)), denom));
+    const __m256d sStar = _mm256_add_pd(s0, _mm256_max_pd(dyn, zero));
+    const __m256d sRatio =
+        _mm256_div_pd(sStar, _mm256_max_pd(_mm256_loadu_pd(gap + i), floor));
+    const __m256d rest = _mm256_sub_pd(_mm256_sub_pd(one, termFree),
+                                       _mm256_mul_pd(sRatio, sRatio));
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(a, rest));
+  }
+  return i;
+}
+#endif
+
+template <int Delta>
+void batch(const IDMParams &p, std::size_t n, const double *v,
+           const double *v0, const double *gap, const double *dv,
+           double *out) {
+  std::size_t done = 0;
+#if defined(__AVX2__)
+  done = avx2Batch<Delta>(p, n, v, v0, gap, dv, out);
+#endif
+  scalarBatch<Delta>(p, done, n, v, v0, gap, dv, out);
+}
+
+} // namespace
+
+void idm_accel_batch(const IDMParams &p, std::size_t n, const double *v,
+                     const double *v0, const double *gap, const double *dv,
+                     double *out) {
+  if (p.delta == 4.0)
+    return batch<4>(p, n, v, v0, gap, dv, out);
+  if (p.delta == 2.0)
+    return batch<2>(p, n, v, v0, gap, dv, out);
+  if (p.delta == 1.0)
+    return batch<1>(p, n, v, v0, gap, dv, out);
+  if (p.delta == 3.0)
+    return batch<3>(p, n, v, v0, gap, dv, out);
+  for (std::size_t i = 0; i < n; ++i)
+    out[i] = idm_accel(v[i], v0[i], gap[i], dv[i], p);
+}
+
+bool idm_batch_uses_avx2() noexcept {
+#if defined(__AVX2__)
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,190 @@
+/**
+ * @file MesoscopicModel.cpp
+ * @brief Exit events, FIFO and storage limits of the mesoscopic model.
+ */
+#include "Easy_rider/Vehicles/MesoscopicModel.h"
+
+#include "Easy_rider/Vehicles/VehicleStore.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kTiny = 1e-9;
+} // namespace
+
+MesoscopicModel::Timing &MesoscopicModel::timing(const VehicleStore &store,
+                                                 std::size_t slot) {
+  const std::uint32_t index = store.cold_[slot].handle_.index;
+  if (index >= timing_.size())
+    timing_.resize(store.handles_.size());
+  return timing_[index];
+}
+
+int MesoscopicModel::capacity(const Vehicle &v, std::size_t edgeIdx) {
+  return std::max(1, v.graph_->getEdges()[edgeIdx].getCapacityVehicles());
+}
+
+double MesoscopicModel::crossingSpeed(const VehicleStore &store,
+                                      std::size_t slot, std::size_t edgeIdx,
+                                      double speed) const {
+  const Vehicle &v = store.cold_[slot];
+  const double vFree =
+      v.edgeTimes_ && edgeIdx < v.edgeTimes_->edgeCount()
+          ? v.edgeTimes_->freeSpeed(edgeIdx)
+          : static_cast<double>(v.graph_->getEdges()[edgeIdx].getMaxSpeed());
+  const int cap = capacity(v, edgeIdx);
+  const auto full =
+      static_cast<int>(std::ceil(options_.storageFactor * cap));
+  const double floor = std::min(
+      store.params(slot).v0, CongestionModel::speedForLoad(vFree, cap, full));
+  return std::max({kTiny, speed, floor});
+}
+
+void MesoscopicModel::schedule(const VehicleStore &store, std::size_t slot,
+                               double time) {
+  timing(store, slot).eventAt = time;
+  events_.push(Event{time, store.cold_[slot].handle_});
+}
+
+void MesoscopicModel::enable(VehicleStore &store) {
+  for (std::size_t slot = 0; slot < store.size(); ++slot) {
+    const std::uint32_t e = store.edge_[slot];
+    if (e == VehicleStore::kNoEdge)
+      continue;
+    const Vehicle &v = store.cold_[slot];
+    const double speed = crossingSpeed(
+        store, slot, e, std::min(store.params(slot).v0, v.edgeSpeed(e)));
+    Timing &t = timing(store, slot);
+    t.enteredAt = store.clock_ - store.progress_[slot] / speed;
+    t.exitAt = t.enteredAt + v.graph_->getEdges()[e].getLength() / speed;
+    t.waitingSince = -1.0;
+    store.speed_[slot] = speed;
+    schedule(store, slot, std::max(store.clock_, t.exitAt));
+  }
+}
+
+void MesoscopicModel::disable(VehicleStore &store) {
+  for (std::size_t slot = 0; slot < store.size(); ++slot) {
+    if (store.edge_[slot] != VehicleStore::kNoEdge)
+      store.progress_[slot] = progress(store, slot);
+  }
+  events_ = {};
+  waiters_.clear();
+  edgeLastExit_.clear();
+}
+
+void MesoscopicModel::onEnter(VehicleStore &store, std::size_t slot,
+                              double speed) {
+  const std::uint32_t e = store.edge_[slot];
+  const double len = store.cold_[slot].graph_->getEdges()[e].getLength();
+  speed = crossingSpeed(store, slot, e, speed);
+  Timing &t = timing(store, slot);
+  t.enteredAt = store.clock_;
+  t.exitAt = store.clock_ + len / speed;
+  t.waitingSince = -1.0;
+  store.speed_[slot] = speed;
+  schedule(store, slot, t.exitAt);
+}
+
+void MesoscopicModel::onLeave(VehicleStore &store, std::size_t edgeIdx) {
+  const double now = store.clock_;
+
+  // The new front may have been parked behind the vehicle that left.
+  if (const std::uint32_t front = store.lanes_.front(edgeIdx);
+      front != EdgeLanes::kNone) {
+    const Timing &f = timing(store, front);
+    if (f.eventAt == kNever)
+      schedule(store, front,
+               std::max(now + options_.exitHeadway, f.exitAt));
+  }
+
+  if (edgeIdx >= waiters_.size())
+    return;
+  auto &waiting = waiters_[edgeIdx];
+  while (!waiting.empty()) {
+    const VehicleHandle h = waiting.front();
+    waiting.pop_front();
+    // Skip vehicles removed, rerouted or already moved on since they queued.
+    const std::uint32_t slot = store.slotOf(h);
+    if (slot == VehicleStore::kNoSlot || store.nextEdge_[slot] != edgeIdx ||
+        timing(store, slot).waitingSince < 0.0)
+      continue;
+    schedule(store, slot, now);
+    break;
+  }
+}
+
+void MesoscopicModel::advance(VehicleStore &store, double dt) {
+  const double end = store.clock_ + dt;
+  while (!events_.empty() && events_.top().time <= end) {
+    const Event ev = events_.top();
+    events_.pop();
+    const std::uint32_t slot = store.slotOf(ev.vehicle);
+    if (slot == VehicleStore::kNoSlot ||
+        timing_[ev.vehicle.index].eventAt != ev.time)
+      continue; // stale
+    // Cooldowns and new events are measured from the event's own time.
+    store.clock_ = std::max(store.clock_, ev.time);
+    tryExit(store, slot);
+  }
+  store.clock_ = end;
+}
+
+void MesoscopicModel::tryExit(VehicleStore &store, std::size_t slot) {
+  const double now = store.clock_;
+  Timing &t = timing(store, slot);
+  t.eventAt = kNever;
+  const std::uint32_t e = store.edge_[slot];
+  if (e == VehicleStore::kNoEdge)
+    return;
+
+  // FIFO: stay parked until the vehicle ahead leaves (see onLeave()).
+  if (store.lanes_.leader(slot) != EdgeLanes::kNone)
+    return;
+
+  if (e >= edgeLastExit_.size())
+    edgeLastExit_.resize(e + 1, -kNever);
+  if (const double free = edgeLastExit_[e] + options_.exitHeadway;
+      now < free) {
+    schedule(store, slot, free);
+    return;
+  }
+
+  // Spillback: wait at the end of the edge while the next one is full.
+  const Vehicle &v = store.cold_[slot];
+  const std::uint32_t next = store.nextEdge_[slot];
+  const bool stuck = t.waitingSince >= 0.0 &&
+                     now >= t.waitingSince + options_.stuckTime;
+  if (next != VehicleStore::kNoEdge && !stuck) {
+    if (static_cast<double>(store.lanes_.count(next)) >=
+        options_.storageFactor * capacity(v, next)) {
+      if (t.waitingSince < 0.0)
+        t.waitingSince = now;
+      if (next >= waiters_.size())
+        waiters_.resize(next + 1);
+      waiters_[next].push_back(v.handle_);
+      store.speed_[slot] = 0.0;
+      schedule(store, slot, t.waitingSince + options_.stuckTime);
+      return;
+    }
+  }
+
+  t.waitingSince = -1.0;
+  edgeLastExit_[e] = now;
+  store.cold_[slot].finishEdge();
+}
+
+double MesoscopicModel::progress(const VehicleStore &store,
+                                 std::size_t slot) const {
+  const std::uint32_t e = store.edge_[slot];
+  const std::uint32_t index = store.cold_[slot].handle_.index;
+  if (e == VehicleStore::kNoEdge || index >= timing_.size())
+    return store.progress_[slot];
+  const Timing &t = timing_[index];
+  const double len = store.cold_[slot].graph_->getEdges()[e].getLength();
+  const double span = t.exitAt - t.enteredAt;
+  if (span <= 0.0)
+    return len;
+  return len * std::clamp((store.clock_ - t.enteredAt) / span, 0.0, 1.0);
+}
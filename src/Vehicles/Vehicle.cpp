@@ -1,73 +1,141 @@
 #include "Easy_rider/Vehicles/Vehicle.h"
 
 #include "Easy_rider/Congestion/CongestionModel.h"
-#include "Easy_rider/Vehicles/IDM.h"
+#include "Easy_rider/Congestion/LoadForecast.h"
+#include "Easy_rider/Vehicles/VehicleStore.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <limits>
+#include <span>
+#include <utility>
 
-#include "Easy_rider/RoutingStrategies/AStarStrategy.h"
-#include "Easy_rider/RoutingStrategies/DijkstraStrategy.h"
+#include "Easy_rider/RoutingStrategies/StrategyTable.h"
 
 namespace {
 int s_nextVehicleId = 1;
 constexpr double kTiny = 1e-9;
-constexpr double kDtFloor = 1e-3;
 } // namespace
 
-Vehicle::Vehicle(const Graph<Intersection, Road> &graph,
-                 CongestionModel *congestion, const IDMParams &params)
-    : id_(s_nextVehicleId++), graph_(&graph), congestion_(congestion),
-      idmParams_(params) {}
+Vehicle::Vehicle(VehicleStore &store, std::size_t slot,
+                 const Graph<Intersection, Road> &graph,
+                 CongestionModel *congestion, const EdgeTimeTable *edgeTimes,
+                 VehicleClass vehicleClass)
+    : store_(&store), slot_(slot), id_(s_nextVehicleId++), graph_(&graph),
+      congestion_(congestion), edgeTimes_(edgeTimes), class_(vehicleClass) {}
+
+void Vehicle::retire() {
+  if (const auto e = currentEdgeIndex())
+    store_->leaveLane(*e, static_cast<std::uint32_t>(slot_));
+  if (forecast_)
+    forecast_->forget(id_);
+}
 
-void Vehicle::setStrategy(StrategyAlgoritm algo) {
-  using EdgeTimeFn = std::function<double(const Road &)>;
-  EdgeTimeFn timeFn = [this](const Road &e) {
-    assert(congestion_ && "Vehicle must have a congestion model");
-    return congestion_->edgeTime(e, idmParams_.v0);
-  };
-
-  switch (algo) {
-  case StrategyAlgoritm::AStar:
-    strategy_ = std::make_shared<AStarStrategy>(std::move(timeFn));
-    break;
-  case StrategyAlgoritm::Dijkstra:
-    strategy_ = std::make_shared<DijkstraStrategy>(std::move(timeFn));
-    break;
-  }
+double Vehicle::currentSpeed() const { return store_->speed_[slot_]; }
+
+double Vehicle::edgeProgress() const { return store_->progress(slot_); }
+
+std::optional<std::size_t> Vehicle::currentEdgeIndex() const {
+  const std::uint32_t e = store_->edge_[slot_];
+  if (e == VehicleStore::kNoEdge)
+    return std::nullopt;
+  return e;
+}
+
+const IDMParams &Vehicle::idmParams() const { return store_->params(slot_); }
+
+void Vehicle::setIDMParams(const IDMParams &p) {
+  store_->params_[slot_] = store_->paramsIndex(p);
+}
+
+std::optional<Vehicle::RenderState> Vehicle::renderState() const {
+  if (route_.empty() || routeIndex_ + 1 >= route_.size())
+    return std::nullopt;
+  return RenderState{route_[routeIndex_], route_[routeIndex_ + 1],
+                     edgeProgress(), currentSpeed()};
+}
 
+double Vehicle::sinceRecompute() const {
+  return store_->clock() - recomputedAt_;
+}
+
+void Vehicle::setStrategy(StrategyAlgoritm algo) {
+  algo_ = algo;
+  if (strategies_)
+    strategyGeneration_ = strategies_->generation();
   // Trigger a recompute soon after strategy change.
   pendingReroute_ = true;
-  sinceRecompute_ = recomputeCooldown_;
+  recomputedAt_ = store_->clock() - recomputeCooldown_;
+}
+
+void Vehicle::syncStrategy() {
+  if (strategies_ && strategies_->generation() != strategyGeneration_)
+    setStrategy(strategies_->active());
+}
+
+StrategyAlgoritm Vehicle::strategyAlgorithm() const {
+  if (strategies_ && strategies_->generation() != strategyGeneration_)
+    return strategies_->active();
+  return algo_;
+}
+
+RouteStrategy *Vehicle::strategy() const {
+  return strategies_ ? &strategies_->get(strategyAlgorithm()) : nullptr;
+}
+
+void Vehicle::takeBuffers(Vehicle &retired) {
+  route_.swap(retired.route_);
+  legEdges_.swap(retired.legEdges_);
+  legTimes_.swap(retired.legTimes_);
+  legsByEdge_.swap(retired.legsByEdge_);
+  route_.clear();
+  legEdges_.clear();
+  legTimes_.clear();
+  legsByEdge_.clear();
 }
 
 void Vehicle::setRoute(const std::vector<int> &routeIds) {
-  route_ = routeIds;
+  route_.assign(routeIds.begin(), routeIds.end());
+  startRoute();
+}
+
+void Vehicle::startRoute() {
   routeIndex_ = 0;
-  edgeProgress_ = 0.0;
-  currentSpeed_ = 0.0;
+  store_->progress_[slot_] = 0.0;
+  store_->speed_[slot_] = 0.0;
+  priceLegs();
 
   if (route_.size() >= 2) {
     enterEdge(route_[0], route_[1]);
   } else {
-    currentEdge_ = {-1, -1};
+    leaveEdge();
+    store_->arrived_.push_back(handle_); // Nothing to drive.
   }
+  replanForecast();
+}
+
+void Vehicle::replanForecast() {
+  if (forecast_)
+    forecast_->replan(id_, static_cast<std::size_t>(class_), route_,
+                      routeIndex_, edgeProgress());
 }
 
 std::optional<int> Vehicle::currentNodeId() const {
   // Exactly at a node if not on an edge or progress == 0 at edge start/end.
+  // Off an edge, the vehicle waits at the node it last reached.
   if (currentEdge_.first < 0)
-    return route_.empty() ? std::nullopt : std::optional<int>{route_[0]};
+    return routeIndex_ < route_.size()
+               ? std::optional<int>{route_[routeIndex_]}
+               : std::nullopt;
 
-  const Road *e = findEdge(currentEdge_.first, currentEdge_.second);
-  if (!e)
+  const auto eIdx = currentEdgeIndex();
+  if (!eIdx)
     return std::nullopt;
 
-  if (edgeProgress_ <= 0.0)
+  if (edgeProgress() <= 0.0)
     return currentEdge_.first;
-  if (edgeProgress_ >= e->getLength())
+  if (edgeProgress() >= graph_->getEdges()[*eIdx].getLength())
     return currentEdge_.second;
   return std::nullopt;
 }
@@ -79,42 +147,82 @@ std::optional<int> Vehicle::goalId() const {
 }
 
 const Road *Vehicle::findEdge(int fromId, int toId) const {
-  try {
-    const int uIdx = static_cast<int>(graph_->indexOfId(fromId));
-    const int vIdx = static_cast<int>(graph_->indexOfId(toId));
-    for (const auto &nbr : graph_->outgoing(uIdx)) {
-      if (nbr.first == vIdx)
-        return &nbr.second.get();
-    }
-  } catch (...) {
-    return nullptr;
-  }
-  return nullptr;
+  const auto eIdx = graph_->edgeIndexOf(fromId, toId);
+  return eIdx ? &graph_->getEdges()[*eIdx] : nullptr;
+}
+
+double Vehicle::edgeSpeed(std::size_t edgeIdx) const {
+  if (edgeTimes_ && edgeIdx < edgeTimes_->edgeCount())
+    return edgeTimes_->effectiveSpeed(edgeIdx);
+  const Road &e = graph_->getEdges()[edgeIdx];
+  return congestion_ ? congestion_->effectiveSpeed(e)
+                     : static_cast<double>(e.getMaxSpeed());
 }
 
 void Vehicle::enterEdge(int fromId, int toId) {
+  const auto slot = static_cast<std::uint32_t>(slot_);
+  // A vehicle is queued on one edge at most.
+  if (const auto e = currentEdgeIndex())
+    store_->leaveLane(*e, slot);
   currentEdge_ = {fromId, toId};
-  edgeProgress_ = 0.0;
-  leader_.reset();
+  const auto eIdx = graph_->edgeIndexOf(fromId, toId);
+  store_->edge_[slot_] =
+      eIdx ? static_cast<std::uint32_t>(*eIdx) : VehicleStore::kNoEdge;
+  store_->progress_[slot_] = 0.0;
+  syncNextEdge();
 
   if (congestion_)
     congestion_->onEnterEdge(currentEdge_);
+  if (!eIdx)
+    return;
+  if (forecast_)
+    forecast_->onEnterEdge(id_, *eIdx);
+  store_->lanes_.enter(*eIdx, slot);
 
   // If entering a slower edge, cap the current speed to local effective limit.
-  if (const Road *e = findEdge(fromId, toId)) {
-    const double vEff = congestion_ ? congestion_->effectiveSpeed(*e)
-                                    : static_cast<double>(e->getMaxSpeed());
-    const double vCap = std::min(idmParams_.v0, vEff);
-    if (currentSpeed_ > vCap)
-      currentSpeed_ = vCap;
-  }
+  const double vCap = std::min(idmParams().v0, edgeSpeed(*eIdx));
+  if (store_->mesoscopic_)
+    store_->meso_.onEnter(*store_, slot_, vCap); // crosses at vCap
+  else
+    store_->speed_[slot_] = std::min(store_->speed_[slot_], vCap);
+}
+
+void Vehicle::syncNextEdge() {
+  const std::size_t next = routeIndex_ + 1;
+  store_->nextEdge_[slot_] =
+      next < legEdges_.size() && legEdges_[next] != kNoEdge
+          ? static_cast<std::uint32_t>(legEdges_[next])
+          : VehicleStore::kNoEdge;
 }
 
 void Vehicle::leaveEdge() {
   if (congestion_ && currentEdge_.first >= 0)
     congestion_->onExitEdge(currentEdge_);
+  if (const auto e = currentEdgeIndex())
+    store_->leaveLane(*e, static_cast<std::uint32_t>(slot_));
   currentEdge_ = {-1, -1};
-  leader_.reset();
+  store_->edge_[slot_] = VehicleStore::kNoEdge;
+  store_->nextEdge_[slot_] = VehicleStore::kNoEdge;
+}
+
+void Vehicle::finishEdge() {
+  leaveEdge();
+  if (routeIndex_ < legTimes_.size())
+    timeAhead_ -= legTimes_[routeIndex_];
+  ++routeIndex_;
+  if (routeIndex_ >= route_.size() - 1) {
+    store_->speed_[slot_] = 0.0; // Arrived
+    store_->arrived_.push_back(handle_);
+    if (forecast_)
+      forecast_->forget(id_);
+    return;
+  }
+  enterEdge(route_[routeIndex_], route_[routeIndex_ + 1]);
+
+  // If the new edge is congested, mark for re-route consideration.
+  if (const auto e = currentEdgeIndex();
+      e && congestion_ && edgeSpeed(*e) < graph_->getEdges()[*e].getMaxSpeed())
+    onCongestion();
 }
 
 bool Vehicle::hasArrived() const noexcept {
@@ -125,176 +233,186 @@ bool Vehicle::hasArrived() const noexcept {
   return g.has_value() && n.has_value() && atEndIdx && (*g == *n);
 }
 
-double Vehicle::estimateRemainingETA(const std::vector<int> &path,
-                                     std::size_t idx, double sOnEdge) const {
-  if (!graph_ || !congestion_ || path.size() < 2 || idx >= path.size() - 1) {
+bool Vehicle::finished() const noexcept {
+  return route_.size() < 2 || hasArrived();
+}
+
+double Vehicle::legTime(std::size_t edgeIdx) const {
+  if (edgeIdx == kNoEdge || (!congestion_ && !edgeTimes_))
     return 0.0;
+  const double len = std::max(0.0, graph_->getEdges()[edgeIdx].getLength());
+  return len / std::max(kTiny, edgeSpeed(edgeIdx));
+}
+
+void Vehicle::priceLegs() {
+  legEdges_.clear();
+  legTimes_.clear();
+  legsByEdge_.clear();
+  for (std::size_t i = 0; i + 1 < route_.size(); ++i) {
+    const std::size_t e =
+        graph_->edgeIndexOf(route_[i], route_[i + 1]).value_or(kNoEdge);
+    legEdges_.push_back(e);
+    legTimes_.push_back(legTime(e));
+    if (e != kNoEdge)
+      legsByEdge_.emplace_back(e, i);
   }
+  std::sort(legsByEdge_.begin(), legsByEdge_.end());
+  timeAhead_ = 0.0;
+  for (std::size_t i = routeIndex_; i < legTimes_.size(); ++i)
+    timeAhead_ += legTimes_[i];
+  legEpoch_ = edgeTimes_ ? edgeTimes_->epoch() : 0;
+}
 
-  double eta = 0.0;
+void Vehicle::refreshLegTimes() const {
+  if (routeIndex_ >= legTimes_.size())
+    return;
+  const std::size_t ahead = legTimes_.size() - routeIndex_;
 
-  // Remaining segment on the current edge.
-  if (const Road *e = findEdge(path[idx], path[idx + 1])) {
-    const double len = std::max(0.0, e->getLength() - std::max(0.0, sOnEdge));
-    const double v = std::max(kTiny, congestion_->effectiveSpeed(*e));
-    eta += len / v;
+  // Without a snapshot speeds change unannounced: always re-price.
+  std::optional<std::span<const std::size_t>> changes;
+  if (edgeTimes_) {
+    if (edgeTimes_->epoch() == legEpoch_)
+      return;
+    changes = edgeTimes_->changesSince(legEpoch_);
+    legEpoch_ = edgeTimes_->epoch();
   }
 
-  // Full lengths of subsequent edges.
-  for (std::size_t i = idx + 1; i + 1 < path.size(); ++i) {
-    if (const Road *e = findEdge(path[i], path[i + 1])) {
-      const double len = std::max(0.0, e->getLength());
-      const double v = std::max(kTiny, congestion_->effectiveSpeed(*e));
-      eta += len / v;
+  if (changes && changes->size() < ahead) {
+    for (const std::size_t e : *changes) {
+      auto it = std::lower_bound(legsByEdge_.begin(), legsByEdge_.end(),
+                                 std::pair<std::size_t, std::size_t>{e, 0});
+      for (; it != legsByEdge_.end() && it->first == e; ++it) {
+        if (it->second < routeIndex_)
+          continue;
+        const double t = legTime(e);
+        timeAhead_ += t - legTimes_[it->second];
+        legTimes_[it->second] = t;
+      }
     }
+    return;
+  }
+
+  timeAhead_ = 0.0;
+  for (std::size_t i = routeIndex_; i < legTimes_.size(); ++i) {
+    legTimes_[i] = legTime(legEdges_[i]);
+    timeAhead_ += legTimes_[i];
+  }
+}
+
+double Vehicle::remainingETA() const {
+  refreshLegTimes();
+  if (routeIndex_ >= legTimes_.size())
+    return 0.0;
+  // Only the part of the current leg still ahead counts.
+  double done = 0.0;
+  if (currentEdge_.first >= 0 && legEdges_[routeIndex_] != kNoEdge) {
+    const double len =
+        graph_->getEdges()[legEdges_[routeIndex_]].getLength();
+    if (len > 0.0)
+      done = std::clamp(edgeProgress() / len, 0.0, 1.0);
   }
-  return eta;
+  return std::max(0.0, timeAhead_ - legTimes_[routeIndex_] * done);
 }
 
 void Vehicle::onCongestion() { pendingReroute_ = true; }
 
+bool Vehicle::wantsReroute() const {
+  // A fleet-wide strategy switch not yet picked up counts as a fresh
+  // setStrategy() (see syncStrategy()).
+  const bool switched =
+      strategies_ && strategies_->generation() != strategyGeneration_;
+  return (pendingReroute_ || switched) && strategies_ && !rerouteInFlight_ &&
+         (switched || sinceRecompute() >= recomputeCooldown_) &&
+         route_.size() >= 2 && routeIndex_ + 1 < route_.size();
+}
+
+double Vehicle::distanceToNextNode() const {
+  const auto eIdx = currentEdgeIndex();
+  if (!eIdx)
+    return 0.0;
+  return std::max(0.0,
+                  graph_->getEdges()[*eIdx].getLength() - edgeProgress());
+}
+
 void Vehicle::recomputeRouteIfNeeded() {
-  if (!strategy_ || sinceRecompute_ < recomputeCooldown_)
+  syncStrategy();
+  if (!strategies_ || rerouteInFlight_ ||
+      sinceRecompute() < recomputeCooldown_)
     return;
 
   const auto goal = goalId();
   if (!goal)
     return;
 
-  // If mid-edge, plan from the next node; otherwise from the current node.
-  const int startId = currentNodeId().value_or(currentEdge_.second);
-  const auto newRoute = strategy_->computeRoute(startId, *goal, *graph_);
-  if (newRoute.size() < 2)
+  // Plan from the next node: the current edge is always finished first.
+  const int startId = currentEdge_.first >= 0
+                          ? currentEdge_.second
+                          : currentNodeId().value_or(*goal);
+  if (startId == *goal)
     return;
 
-  if (newRoute == route_) {
-    pendingReroute_ = false;
+  if (rerouteRequester_) {
+    rerouteInFlight_ = true;
+    (*rerouteRequester_)(*this, startId, *goal);
     return;
   }
-
-  // Compare ETAs from current situation vs. new route.
-  const std::vector<int> oldRoute = route_;
-  const std::size_t oldIdx = routeIndex_;
-  const double oldS = currentNodeId() ? 0.0 : std::max(0.0, edgeProgress_);
-  const double oldETA = estimateRemainingETA(oldRoute, oldIdx, oldS);
-
-  double newETA = 0.0;
-
-  if (currentNodeId()) {
-    // At a node: switch immediately to the new route; preserve speed.
-    const double vKeep = currentSpeed_;
-    setRoute(newRoute);
-    currentSpeed_ = vKeep;
-    newETA = estimateRemainingETA(newRoute, /*idx=*/0, /*sOnEdge=*/0.0);
-  } else {
-    // Mid-edge: keep traversing the current edge, then follow newRoute.
-    route_.assign(newRoute.begin(), newRoute.end());
-    routeIndex_ = 0;
-    newETA = estimateRemainingETA(newRoute, /*idx=*/0,
-                                  /*sOnEdge=*/std::max(0.0, edgeProgress_));
-  }
-
-  pendingReroute_ = false;
-  sinceRecompute_ = 0.0;
-
-  if (onRerouteApplied_)
-    onRerouteApplied_(id_, oldETA, newETA);
+  applyReroute(startId, strategy()->computeRoute(startId, *goal, *graph_));
 }
 
-void Vehicle::update(double dt) {
-  sinceRecompute_ += dt;
-
-  if (dt <= 0.0)
-    return;
-  if (route_.size() < 2 || routeIndex_ >= route_.size() - 1)
-    return;
-
-  const Road *edge = findEdge(currentEdge_.first, currentEdge_.second);
-  if (!edge)
-    return;
-
-  // Effective speed on current edge (congestion-aware), capped by vehicle v0.
-  const double vEffCurRaw = congestion_
-                                ? congestion_->effectiveSpeed(*edge)
-                                : static_cast<double>(edge->getMaxSpeed());
-  double v0_local = std::min(idmParams_.v0, vEffCurRaw);
-
-  // Lookahead: plan to match the next edge's cap by the end of this edge.
-  if (routeIndex_ + 1 < static_cast<int>(route_.size()) - 1) {
-    const int nextFrom = route_[routeIndex_ + 1];
-    const int nextTo = route_[routeIndex_ + 2];
-    if (const Road *nextEdge = findEdge(nextFrom, nextTo)) {
-      const double vEffNextRaw =
-          congestion_ ? congestion_->effectiveSpeed(*nextEdge)
-                      : static_cast<double>(nextEdge->getMaxSpeed());
-      const double v0_next = std::min(idmParams_.v0, vEffNextRaw);
-
-      const double s_rem = std::max(0.0, edge->getLength() - edgeProgress_);
-      const double bPlan = std::max(0.1, idmParams_.b);
-
-      // Kinematic cap to ensure we can reach v0_next by the edge end.
-      double vcap =
-          std::sqrt(std::max(0.0, v0_next * v0_next + 2.0 * bPlan * s_rem));
-      vcap += kTiny;
-      v0_local = std::min(v0_local, vcap);
-    }
+bool Vehicle::applyReroute(int startId, const std::vector<int> &newRoute) {
+  rerouteInFlight_ = false;
+  if (newRoute.size() < 2 || newRoute.front() != startId)
+    return false;
+
+  // Build the full route (the current edge, if any, followed by newRoute)
+  // in the store's spare buffer; the replaced route becomes the next spare.
+  std::vector<int> &spliced = store_->spareRoute_;
+  spliced.clear();
+  double sOnEdge = 0.0;
+  if (currentEdge_.first >= 0) {
+    if (currentEdge_.second != startId)
+      return false; // Vehicle already passed startId: result is stale.
+    spliced.push_back(currentEdge_.first);
+    sOnEdge = std::max(0.0, edgeProgress());
+  } else if (currentNodeId() != startId) {
+    return false;
   }
+  spliced.insert(spliced.end(), newRoute.begin(), newRoute.end());
 
-  const double v0 = v0_local;
-
-  // IDM acceleration based on leader info (if any).
-  double accel = 0.0;
-  if (leader_ && leader_->present) {
-    const double gap = std::max(0.0, leader_->gap);
-    const double dv = std::max(0.0, currentSpeed_ - leader_->leaderSpeed);
-
-    accel = idm_accel(currentSpeed_, v0, gap, dv, idmParams_);
+  if (std::equal(spliced.begin(), spliced.end(), route_.begin() + routeIndex_,
+                 route_.end())) {
+    pendingReroute_ = false;
+    return false;
+  }
 
-    const double aMax = std::max(0.1, idmParams_.a);
-    const double bMax = std::max(0.1, idmParams_.b);
-    if (accel > aMax)
-      accel = aMax;
-    if (accel < -bMax)
-      accel = -bMax;
+  // Compare ETAs from current situation vs. new route. The new route is
+  // priced once here and its legs are kept for later ETA queries.
+  const double oldETA = remainingETA();
+  route_.swap(spliced);
+  if (currentEdge_.first >= 0) {
+    // Keep traversing the current edge, then follow the new route.
+    routeIndex_ = 0;
+    priceLegs();
+    syncNextEdge();
+    replanForecast();
   } else {
-    // Free road: relax toward v0 within a single step.
-    if (currentSpeed_ < v0) {
-      accel =
-          std::min(idmParams_.a, (v0 - currentSpeed_) / std::max(kDtFloor, dt));
-    } else if (currentSpeed_ > v0) {
-      accel = -std::min(idmParams_.b,
-                        (currentSpeed_ - v0) / std::max(kDtFloor, dt));
-    } else {
-      accel = 0.0;
-    }
+    // At a node: switch immediately to the new route; preserve speed.
+    const double vKeep = currentSpeed();
+    startRoute();
+    store_->speed_[slot_] = vKeep;
   }
 
-  // Integrate speed with clamping to [0, v0] (if accelerating).
-  const double vNext = currentSpeed_ + accel * dt;
-  currentSpeed_ = (accel >= 0.0) ? std::min(vNext, v0) : std::max(0.0, vNext);
-
-  // Advance along the edge.
-  edgeProgress_ += currentSpeed_ * dt;
-
-  // Edge transition.
-  if (edgeProgress_ + kTiny >= edge->getLength()) {
-    leaveEdge();
-    ++routeIndex_;
-    if (routeIndex_ >= route_.size() - 1) {
-      currentSpeed_ = 0.0; // Arrived
-      return;
-    }
-    enterEdge(route_[routeIndex_], route_[routeIndex_ + 1]);
+  double newETA = timeAhead_;
+  if (sOnEdge > 0.0 && legEdges_.front() != kNoEdge) {
+    const double len = graph_->getEdges()[legEdges_.front()].getLength();
+    if (len > 0.0)
+      newETA -= legTimes_.front() * std::min(1.0, sOnEdge / len);
+  }
 
-    // If the new edge is congested, mark for re-route consideration.
-    const Road *newEdge = findEdge(currentEdge_.first, currentEdge_.second);
-    if (newEdge && congestion_ &&
-        congestion_->effectiveSpeed(*newEdge) < newEdge->getMaxSpeed()) {
-      onCongestion();
-    }
+  pendingReroute_ = false;
+  recomputedAt_ = store_->clock();
 
-    if (pendingReroute_) {
-      recomputeRouteIfNeeded();
-    }
-  }
+  if (onRerouteApplied_)
+    (*onRerouteApplied_)(id_, oldETA, newETA);
+  return true;
 }
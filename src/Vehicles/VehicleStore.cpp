@@ -0,0 +1,294 @@
+/**
+ * @file VehicleStore.cpp
+ * @brief Fleet-wide IDM integration over the structure-of-arrays store.
+ */
+#include "Easy_rider/Vehicles/VehicleStore.h"
+
+#include "Easy_rider/Vehicles/Car.h"
+#include "Easy_rider/Vehicles/IDMBatch.h"
+#include "Easy_rider/Vehicles/Truck.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace {
+constexpr double kTiny = 1e-9;
+constexpr double kDtFloor = 1e-3;
+} // namespace
+
+VehicleStore::VehicleStore() {
+  static_assert(static_cast<std::size_t>(Car::kClass) == 0 &&
+                    static_cast<std::size_t>(Truck::kClass) == 1 &&
+                    kVehicleClassCount == 2,
+                "paramSets_ starts with one entry per VehicleClass");
+  paramSets_ = {Car::kIDMParams, Truck::kIDMParams};
+}
+
+Vehicle &VehicleStore::emplace(const Graph<Intersection, Road> &graph,
+                               CongestionModel *congestion,
+                               const EdgeTimeTable *edgeTimes,
+                               VehicleClass cls) {
+  const std::size_t slot = cold_.size();
+  speed_.push_back(0.0);
+  progress_.push_back(0.0);
+  edge_.push_back(kNoEdge);
+  nextEdge_.push_back(kNoEdge);
+  leaderGap_.push_back(0.0);
+  leaderSpeed_.push_back(0.0);
+  leaderPresent_.push_back(0);
+  params_.push_back(static_cast<std::uint8_t>(cls));
+  lanes_.addSlot();
+  cold_.push_back(Vehicle(*this, slot, graph, congestion, edgeTimes, cls));
+  ++classCount_[static_cast<std::size_t>(cls)];
+  if (!retired_.empty()) {
+    cold_.back().takeBuffers(retired_.back());
+    retired_.pop_back();
+    ++recycled_;
+  }
+
+  std::uint32_t index = 0;
+  if (freeHandles_.empty()) {
+    index = static_cast<std::uint32_t>(handles_.size());
+    handles_.emplace_back();
+  } else {
+    index = freeHandles_.back();
+    freeHandles_.pop_back();
+  }
+  handles_[index].slot = static_cast<std::uint32_t>(slot);
+  cold_.back().handle_ = {index, handles_[index].generation};
+  return cold_.back();
+}
+
+void VehicleStore::erase(std::size_t slot) {
+  cold_[slot].retire();
+  const VehicleHandle gone = cold_[slot].handle_;
+  handles_[gone.index].slot = kNoSlot;
+  ++handles_[gone.index].generation;
+  freeHandles_.push_back(gone.index);
+  --classCount_[static_cast<std::size_t>(cold_[slot].class_)];
+  retired_.push_back(std::move(cold_[slot]));
+
+  const std::size_t last = cold_.size() - 1;
+  if (slot != last) {
+    speed_[slot] = speed_[last];
+    progress_[slot] = progress_[last];
+    edge_[slot] = edge_[last];
+    nextEdge_[slot] = nextEdge_[last];
+    leaderGap_[slot] = leaderGap_[last];
+    leaderSpeed_[slot] = leaderSpeed_[last];
+    leaderPresent_[slot] = leaderPresent_[last];
+    params_[slot] = params_[last];
+    lanes_.relocate(edge_[last], static_cast<std::uint32_t>(last),
+                    static_cast<std::uint32_t>(slot));
+    cold_[slot] = std::move(cold_[last]);
+    cold_[slot].slot_ = slot;
+    handles_[cold_[slot].handle_.index].slot =
+        static_cast<std::uint32_t>(slot);
+  }
+  speed_.pop_back();
+  progress_.pop_back();
+  edge_.pop_back();
+  nextEdge_.pop_back();
+  leaderGap_.pop_back();
+  leaderSpeed_.pop_back();
+  leaderPresent_.pop_back();
+  params_.pop_back();
+  lanes_.popSlot();
+  cold_.pop_back();
+}
+
+std::size_t VehicleStore::eraseArrived() {
+  std::size_t removed = 0;
+  for (const VehicleHandle h : arrived_) {
+    // Skip vehicles already removed, or given a new route since arriving.
+    const Vehicle *v = find(h);
+    if (v && v->finished()) {
+      erase(v->slot());
+      ++removed;
+    }
+  }
+  arrived_.clear();
+  return removed;
+}
+
+void VehicleStore::reserve(std::size_t n) {
+  speed_.reserve(n);
+  progress_.reserve(n);
+  edge_.reserve(n);
+  nextEdge_.reserve(n);
+  leaderGap_.reserve(n);
+  leaderSpeed_.reserve(n);
+  leaderPresent_.reserve(n);
+  params_.reserve(n);
+  cold_.reserve(n);
+}
+
+std::uint8_t VehicleStore::paramsIndex(const IDMParams &p) {
+  const auto it = std::find(paramSets_.begin(), paramSets_.end(), p);
+  if (it != paramSets_.end())
+    return static_cast<std::uint8_t>(it - paramSets_.begin());
+  assert(paramSets_.size() < 256 && "Too many distinct IDM parameter sets");
+  paramSets_.push_back(p);
+  return static_cast<std::uint8_t>(paramSets_.size() - 1);
+}
+
+template <class Fn> void VehicleStore::forEachChunk(Fn &&fn) {
+  const std::size_t n = size();
+  const std::size_t chunks = (n + kChunk - 1) / kChunk;
+  batches_.fit(scheduler_);
+  auto chunk = [&](std::size_t worker, std::size_t c) {
+    fn(worker, c * kChunk, std::min(n, (c + 1) * kChunk));
+  };
+  if (scheduler_)
+    scheduler_->parallelFor(chunks, chunk);
+  else
+    for (std::size_t c = 0; c < chunks; ++c)
+      chunk(0, c);
+}
+
+void VehicleStore::updateLeaders(const EdgeTimeTable &times) {
+  forEachChunk([&](std::size_t, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const std::uint32_t e = edge_[i];
+      if (e == kNoEdge)
+        continue; // at node or no route
+      const std::uint32_t lead = lanes_.leader(i);
+      if (lead != EdgeLanes::kNone) {
+        // Leader exists on the same edge ahead of me.
+        leaderPresent_[i] = 1;
+        leaderGap_[i] = std::max(0.0, progress_[lead] - progress_[i]);
+        leaderSpeed_[i] = speed_[lead];
+      } else {
+        // Open road: distance to the end of the edge.
+        leaderPresent_[i] = 0;
+        leaderGap_[i] = std::max(0.0, times.length(e) - progress_[i]);
+        leaderSpeed_[i] = 0.0;
+      }
+    }
+  });
+}
+
+void VehicleStore::advance(double dt, const EdgeTimeTable &times) {
+  clock_ += dt;
+  if (dt <= 0.0)
+    return;
+
+  const std::size_t n = size();
+  target_.resize(n);
+  accel_.resize(n);
+  finished_.resize((n + kChunk - 1) / kChunk);
+  forEachChunk([&](std::size_t worker, std::size_t begin, std::size_t end) {
+    advanceChunk(begin, end, dt, times, batches_[worker],
+                 finished_[begin / kChunk]);
+  });
+
+  // Edge transitions need the route and update shared lanes and congestion
+  // counters, so they run here, in slot order.
+  for (const auto &chunk : finished_) {
+    for (const std::uint32_t i : chunk)
+      cold_[i].finishEdge();
+  }
+}
+
+void VehicleStore::setMesoscopic(bool on, const MesoscopicOptions &options) {
+  meso_.setOptions(options);
+  if (on == mesoscopic_)
+    return;
+  if (on)
+    meso_.enable(*this);
+  else
+    meso_.disable(*this);
+  mesoscopic_ = on;
+}
+
+void VehicleStore::advanceMesoscopic(double dt) {
+  if (dt <= 0.0) {
+    clock_ += dt;
+    return;
+  }
+  meso_.advance(*this, dt);
+}
+
+void VehicleStore::advanceChunk(std::size_t begin, std::size_t end, double dt,
+                                const EdgeTimeTable &times,
+                                std::vector<Batch> &batches,
+                                std::vector<std::uint32_t> &finished) {
+  batches.resize(paramSets_.size());
+  for (auto &b : batches)
+    b.clear();
+
+  // Pass 1: target speeds; free-road vehicles get their acceleration here,
+  // vehicles behind a leader are queued per parameter set for the kernel.
+  for (std::size_t i = begin; i < end; ++i) {
+    const std::uint32_t e = edge_[i];
+    if (e == kNoEdge)
+      continue;
+    const IDMParams &p = paramSets_[params_[i]];
+
+    // Effective speed on current edge (congestion-aware), capped by v0.
+    double v0 = std::min(p.v0, times.effectiveSpeed(e));
+
+    // Lookahead: plan to match the next edge's cap by the end of this edge.
+    if (const std::uint32_t next = nextEdge_[i]; next != kNoEdge) {
+      const double v0Next = std::min(p.v0, times.effectiveSpeed(next));
+      const double sRem = std::max(0.0, times.length(e) - progress_[i]);
+      const double bPlan = std::max(0.1, p.b);
+
+      // Kinematic cap to ensure we can reach v0Next by the edge end.
+      const double vcap =
+          std::sqrt(std::max(0.0, v0Next * v0Next + 2.0 * bPlan * sRem)) +
+          kTiny;
+      v0 = std::min(v0, vcap);
+    }
+    target_[i] = v0;
+
+    const double v = speed_[i];
+    if (leaderPresent_[i]) {
+      Batch &b = batches[params_[i]];
+      b.slot.push_back(static_cast<std::uint32_t>(i));
+      b.v.push_back(v);
+      b.v0.push_back(v0);
+      b.gap.push_back(leaderGap_[i]);
+      b.dv.push_back(std::max(0.0, v - leaderSpeed_[i]));
+    } else if (v < v0) {
+      // Free road: relax toward v0 within a single step.
+      accel_[i] = std::min(p.a, (v0 - v) / std::max(kDtFloor, dt));
+    } else if (v > v0) {
+      accel_[i] = -std::min(p.b, (v - v0) / std::max(kDtFloor, dt));
+    } else {
+      accel_[i] = 0.0;
+    }
+  }
+
+  // Pass 2: IDM for every vehicle with a leader, one batch per parameter set.
+  for (std::size_t k = 0; k < batches.size(); ++k) {
+    Batch &b = batches[k];
+    if (b.slot.empty())
+      continue;
+    const IDMParams &p = paramSets_[k];
+    b.out.resize(b.slot.size());
+    idm_accel_batch(p, b.slot.size(), b.v.data(), b.v0.data(), b.gap.data(),
+                    b.dv.data(), b.out.data());
+    const double lo = -std::max(0.1, p.b);
+    const double hi = std::max(0.1, p.a);
+    for (std::size_t j = 0; j < b.slot.size(); ++j)
+      accel_[b.slot[j]] = std::clamp(b.out[j], lo, hi);
+  }
+
+  // Pass 3: integrate speed with clamping to [0, v0] (if accelerating).
+  finished.clear();
+  for (std::size_t i = begin; i < end; ++i) {
+    const std::uint32_t e = edge_[i];
+    if (e == kNoEdge)
+      continue;
+    const double vNext = speed_[i] + accel_[i] * dt;
+    speed_[i] = accel_[i] >= 0.0 ? std::min(vNext, target_[i])
+                                 : std::max(0.0, vNext);
+    progress_[i] += speed_[i] * dt;
+
+    if (progress_[i] + kTiny >= times.length(e))
+      finished.push_back(static_cast<std::uint32_t>(i));
+  }
+}
@@ -1,5 +1,6 @@
 #include "Easy_rider/Visualizers/SfmlSettingsWindow.h"
 #include "Easy_rider/Parameters/Parameters.h"
+#include "Easy_rider/Visualizers/VisualizerUtils.h"
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -24,12 +25,17 @@ constexpr float kKnobR = 10.f;
 constexpr float kAlgHeaderY = 200.f;
 constexpr float kRadioY = 240.f;
 constexpr float kRadioR = 8.f;
-constexpr float kOptionW = 160.f;   // clickable width per option
+constexpr float kOptionW = 140.f;   // clickable width per option
 constexpr float kOptionH = 26.f;    // clickable height per option
-constexpr float kOptionGapX = 40.f; // gap between options
+constexpr float kOptionGapX = 20.f; // gap between options
 constexpr float kOptionPad = 6.f;   // extra hit padding
 constexpr float kRadioTextDX = 2.f * kRadioR + 8.f; // space from circle to text
 
+// A* weight slider (linear, 1 .. Parameters::astarWeightMax())
+constexpr float kWeightLabelY = 280.f;
+constexpr float kWeightTrackY = 320.f;
+constexpr double kWeightStep = 0.05;
+
 float clampf(float v, float lo, float hi) {
   return std::max(lo, std::min(v, hi));
 }
@@ -55,6 +61,18 @@ float sliderTFromMouseX(float mouseX) {
   const float clampedX = clampf(mouseX, kTrackX, kTrackX + kTrackW);
   return (clampedX - kTrackX) / kTrackW;
 }
+
+float weightToSliderT(double w) {
+  const double span = std::max(1e-9, Parameters::astarWeightMax() - 1.0);
+  return clampf(static_cast<float>((w - 1.0) / span), 0.f, 1.f);
+}
+
+// Snapped to kWeightStep so a drag does not re-plan on every pixel.
+double weightFromSliderT(float t) {
+  const double w = 1.0 + static_cast<double>(clampf(t, 0.f, 1.f)) *
+                             (Parameters::astarWeightMax() - 1.0);
+  return 1.0 + std::round((w - 1.0) / kWeightStep) * kWeightStep;
+}
 } // namespace
 
 SfmlSettingsWindow::SfmlSettingsWindow(const sf::Font &uiFont, Callbacks cbs)
@@ -116,16 +134,21 @@ void SfmlSettingsWindow::processEvents_() {
       // --- Algorithm radio clicks ---
       const float opt1X = kPaddingX;
       const float opt2X = opt1X + kOptionW + kOptionGapX;
+      const float opt3X = opt2X + kOptionW + kOptionGapX;
       const sf::FloatRect opt1Hit(
           opt1X - kOptionPad, kRadioY - 0.5f * kOptionH - kOptionPad,
           kOptionW + 2.f * kOptionPad, kOptionH + 2.f * kOptionPad);
       const sf::FloatRect opt2Hit(
           opt2X - kOptionPad, kRadioY - 0.5f * kOptionH - kOptionPad,
           kOptionW + 2.f * kOptionPad, kOptionH + 2.f * kOptionPad);
+      const sf::FloatRect opt3Hit(
+          opt3X - kOptionPad, kRadioY - 0.5f * kOptionH - kOptionPad,
+          kOptionW + 2.f * kOptionPad, kOptionH + 2.f * kOptionPad);
       if (opt1Hit.contains(mp)) {
         if (algorithm_ != Algorithm::AStar) {
           algorithm_ = Algorithm::AStar;
           Parameters::set_isDijkstra(false);
+          Parameters::set_incrementalRouting(false);
         }
         continue;
       }
@@ -133,6 +156,15 @@ void SfmlSettingsWindow::processEvents_() {
         if (algorithm_ != Algorithm::Dijkstra) {
           algorithm_ = Algorithm::Dijkstra;
           Parameters::set_isDijkstra(true);
+          Parameters::set_incrementalRouting(false);
+        }
+        continue;
+      }
+      if (opt3Hit.contains(mp)) {
+        if (algorithm_ != Algorithm::DStarLite) {
+          algorithm_ = Algorithm::DStarLite;
+          Parameters::set_isDijkstra(false);
+          Parameters::set_incrementalRouting(true);
         }
         continue;
       }
@@ -154,6 +186,17 @@ void SfmlSettingsWindow::processEvents_() {
         const float t = sliderTFromMouseX(mp.x);
         Parameters::set_simulationSpeed(
             fromSliderT(t, Parameters::speedMin(), Parameters::speedMax()));
+        continue;
+      }
+
+      // A* weight slider
+      const sf::FloatRect weightBounds(kTrackX - kKnobR,
+                                       kWeightTrackY - kKnobR,
+                                       kTrackW + 2.f * kKnobR,
+                                       kTrackH + 2.f * kKnobR);
+      if (weightBounds.contains(mp)) {
+        draggingWeight_ = true;
+        Parameters::set_astarWeight(weightFromSliderT(sliderTFromMouseX(mp.x)));
       }
     }
 
@@ -161,24 +204,28 @@ void SfmlSettingsWindow::processEvents_() {
     if (ev.type == sf::Event::MouseButtonReleased &&
         ev.mouseButton.button == sf::Mouse::Left) {
       dragging_ = false;
+      draggingWeight_ = false;
     }
 
     // Dragging: update on mouse move
-    if (ev.type == sf::Event::MouseMoved && dragging_) {
+    if (ev.type == sf::Event::MouseMoved && (dragging_ || draggingWeight_)) {
       const sf::Vector2f mp =
           win_->mapPixelToCoords({ev.mouseMove.x, ev.mouseMove.y});
       const float t = sliderTFromMouseX(mp.x);
-      Parameters::set_simulationSpeed(
-          fromSliderT(t, Parameters::speedMin(), Parameters::speedMax()));
+      if (dragging_)
+        Parameters::set_simulationSpeed(
+            fromSliderT(t, Parameters::speedMin(), Parameters::speedMax()));
+      else
+        Parameters::set_astarWeight(weightFromSliderT(t));
     }
   }
 }
 
 void SfmlSettingsWindow::render_() {
-  const sf::Color panelBg = Parameters::argb(Parameters::panelBg());
-  const sf::Color textColor = Parameters::argb(Parameters::buttonTextColor());
-  const sf::Color trackCol = Parameters::argb(Parameters::buttonBg());
-  const sf::Color fillCol = Parameters::argb(Parameters::buttonOutline());
+  const sf::Color panelBg = argbColor(Parameters::panelBg());
+  const sf::Color textColor = argbColor(Parameters::buttonTextColor());
+  const sf::Color trackCol = argbColor(Parameters::buttonBg());
+  const sf::Color fillCol = argbColor(Parameters::buttonOutline());
   const sf::Color knobCol = textColor;
 
   win_->clear(panelBg);
@@ -240,7 +287,7 @@ void SfmlSettingsWindow::render_() {
     knob.setFillColor(knobCol);
     win_->draw(knob);
   }
-  // Algorithm section (two radio buttons: A* and Dijkstra)
+  // Algorithm section (radio buttons: A*, Dijkstra and D* Lite)
   {
     // Section header
     sf::Text hdr;
@@ -254,6 +301,7 @@ void SfmlSettingsWindow::render_() {
     // Option positions
     const float opt1X = kPaddingX;
     const float opt2X = opt1X + kOptionW + kOptionGapX;
+    const float opt3X = opt2X + kOptionW + kOptionGapX;
 
     auto drawRadio = [&](float cx, const sf::String &label, bool selected) {
       // Circle
@@ -285,6 +333,39 @@ void SfmlSettingsWindow::render_() {
 
     drawRadio(opt1X, "A*", algorithm_ == Algorithm::AStar);
     drawRadio(opt2X, "Dijkstra", algorithm_ == Algorithm::Dijkstra);
+    drawRadio(opt3X, "D* Lite", algorithm_ == Algorithm::DStarLite);
+  }
+  // A* weight slider (routes cost at most weight x optimal)
+  {
+    std::ostringstream oss;
+    oss << "A* weight: " << std::fixed << std::setprecision(2)
+        << Parameters::astarWeight();
+
+    sf::Text label;
+    label.setFont(font_);
+    label.setCharacterSize(18);
+    label.setFillColor(textColor);
+    label.setString(oss.str());
+    label.setPosition(kPaddingX, kWeightLabelY);
+    win_->draw(label);
+
+    const float t = weightToSliderT(Parameters::astarWeight());
+
+    sf::RectangleShape track({kTrackW, kTrackH});
+    track.setPosition(kTrackX, kWeightTrackY);
+    track.setFillColor(trackCol);
+    win_->draw(track);
+
+    sf::RectangleShape fill({t * kTrackW, kTrackH});
+    fill.setPosition(kTrackX, kWeightTrackY);
+    fill.setFillColor(fillCol);
+    win_->draw(fill);
+
+    sf::CircleShape knob(kKnobR);
+    knob.setOrigin(kKnobR, kKnobR);
+    knob.setPosition(kTrackX + t * kTrackW, kWeightTrackY + kTrackH * 0.5f);
+    knob.setFillColor(knobCol);
+    win_->draw(knob);
   }
   win_->display();
 }
@@ -168,7 +168,7 @@ void SfmlSimulationVisualizer::renderFrame() {
 
   processEvents();
 
-  const sf::Color bg = Parameters::argb(Parameters::backgroundColor());
+  const sf::Color bg = argbColor(Parameters::backgroundColor());
   window_->clear(bg);
 
   // 1) Scene (graph + stats)
@@ -194,6 +194,10 @@ void SfmlSimulationVisualizer::drawStats(sf::RenderTarget &rt) {
   snap.avgSpeed = simulation_->averageSpeed();
   snap.rerouteSavedTime = simulation_->rerouteSavedTime();
   snap.rerouteCounts = simulation_->rerouteCount();
+  snap.rerouteDeferred = static_cast<int>(simulation_->rerouteDeferred());
+  const RouteQualityLog::Stats quality = simulation_->routeQuality().stats();
+  snap.astarSettled = quality.settledPerSearch();
+  snap.astarCostRatio = quality.meanCostRatio;
 
   const sf::Vector2u sz = window_->getSize();
   const float windowH = static_cast<float>(sz.y);
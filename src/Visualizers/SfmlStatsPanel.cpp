@@ -1,5 +1,6 @@
 #include "Easy_rider/Visualizers/SfmlStatsPanel.h"
 #include "Easy_rider/Parameters/Parameters.h"
+#include "Easy_rider/Visualizers/VisualizerUtils.h"
 #include <SFML/Graphics.hpp>
 #include <algorithm>
 #include <iomanip>
@@ -39,9 +40,9 @@ void SfmlStatsPanel::drawPanel_(sf::RenderTarget &rt,
 
   sf::RectangleShape bg({width_, hh});
   bg.setPosition(x, y);
-  bg.setFillColor(Parameters::argb(Parameters::panelBg()));
+  bg.setFillColor(argbColor(Parameters::panelBg()));
   bg.setOutlineThickness(1.f);
-  bg.setOutlineColor(Parameters::argb(Parameters::panelOutline()));
+  bg.setOutlineColor(argbColor(Parameters::panelOutline()));
   rt.draw(bg);
 }
 
@@ -62,7 +63,7 @@ void SfmlStatsPanel::drawTexts_(sf::RenderTarget &rt, const sf::Vector2u &sz,
   const float x0 = std::max(0.f, w - width_) + sidePad;
   float y = topPad;
 
-  const sf::Color textColor = Parameters::argb(Parameters::buttonTextColor());
+  const sf::Color textColor = argbColor(Parameters::buttonTextColor());
 
   sf::Text title;
   title.setFont(*font_);
@@ -92,4 +93,7 @@ void SfmlStatsPanel::drawTexts_(sf::RenderTarget &rt, const sf::Vector2u &sz,
   drawBlock("Avg speed:", formatFixed(stats.avgSpeed, 1));
   drawBlock("Reroute saved:", formatFixed(stats.rerouteSavedTime, 1, "s"));
   drawBlock("Reroute counts:", formatFixed(stats.rerouteCounts, 0));
+  drawBlock("Reroute deferred:", formatFixed(stats.rerouteDeferred, 0));
+  drawBlock("A* settled/route:", formatFixed(stats.astarSettled, 1));
+  drawBlock("A* cost ratio:", formatFixed(stats.astarCostRatio, 3));
 }
@@ -83,9 +83,9 @@ void SfmlSimulationVisualizer::drawUi(sf::RenderTarget &rt) {
   // Bottom panel background
   sf::RectangleShape panel({w, h});
   panel.setPosition(0.f, 0.f);
-  panel.setFillColor(Parameters::argb(Parameters::panelBg()));
+  panel.setFillColor(argbColor(Parameters::panelBg()));
   panel.setOutlineThickness(1.f);
-  panel.setOutlineColor(Parameters::argb(Parameters::panelOutline()));
+  panel.setOutlineColor(argbColor(Parameters::panelOutline()));
   rt.draw(panel);
 
   // Buttons
@@ -94,16 +94,16 @@ void SfmlSimulationVisualizer::drawUi(sf::RenderTarget &rt) {
 
     sf::RectangleShape rect({b.rect.width, b.rect.height});
     rect.setPosition({b.rect.left, b.rect.top});
-    rect.setFillColor(Parameters::argb(Parameters::buttonBg()));
+    rect.setFillColor(argbColor(Parameters::buttonBg()));
     rect.setOutlineThickness(2.f);
-    rect.setOutlineColor(Parameters::argb(Parameters::buttonOutline()));
+    rect.setOutlineColor(argbColor(Parameters::buttonOutline()));
     rt.draw(rect);
 
     if (uiFontLoaded_) {
       sf::Text txt;
       txt.setFont(uiFont_);
       txt.setCharacterSize(Parameters::buttonTextSize());
-      txt.setFillColor(Parameters::argb(Parameters::buttonTextColor()));
+      txt.setFillColor(argbColor(Parameters::buttonTextColor()));
 
       // Dynamic label for Pause/Resume button (index 1)
       const bool isPause = (i == static_cast<std::size_t>(Btn::Pause));
@@ -48,13 +48,14 @@ GraphDrawData makeGraphDrawData(const Graph<Intersection, Road> &g) {
   return out;
 }
 
-// Extract current vehicle positions in world coordinates by linearly
-// interpolating along each vehicle's edge based on traveled distance.
+// Extract vehicle positions in world coordinates by linearly interpolating
+// along each vehicle's edge based on traveled distance (itself blended
+// between the last two fixed steps).
 std::vector<sf::Vector2f> extractVehiclePositions(const Simulation &sim) {
   std::vector<sf::Vector2f> pts;
 
   const auto &graph = sim.graph();
-  const auto snapshot = sim.snapshot();
+  const auto snapshot = sim.interpolatedSnapshot();
   pts.reserve(snapshot.size());
 
   for (const auto &v : snapshot) {
@@ -0,0 +1,169 @@
+/**
+ * @file headless_main.cpp
+ * @brief Runs a random network and fleet without a window and reports
+ * throughput.
+ *
+ * Usage: easy_rider_headless [--nodes N] [--cars N] [--trucks N]
+ *        [--seconds S] [--dt S] [--threads N] [--seed N]
+ *        [--model micro|meso]
+ *
+ * The mesoscopic model is event driven, so it can run with a step of a
+ * second or more (--dt 1).
+ *
+ * Replaces the global operator new to count heap allocations made while
+ * the simulation runs.
+ */
+#include "Easy_rider/Parameters/Parameters.h"
+#include "Easy_rider/Simulation/SimulationUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+
+namespace {
+std::atomic<std::uint64_t> g_allocations{0};
+} // namespace
+
+void *operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Options {
+  int nodes = Parameters::targetNodes();
+  int cars = 40;
+  int trucks = 8;
+  double seconds = 60.0;
+  double dt = Parameters::physicsDt();
+  unsigned threads = Parameters::simulationThreads();
+  std::uint32_t seed = 1;
+  bool mesoscopic = Parameters::mesoscopic();
+};
+
+void usage(const char *argv0) {
+  std::cerr << "usage: " << argv0
+            << " [--nodes N] [--cars N] [--trucks N] [--seconds S]"
+               " [--dt S] [--threads N] [--seed N] [--model micro|meso]\n";
+}
+
+bool parse(int argc, char **argv, Options &o) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (i + 1 >= argc)
+      return false;
+    const char *value = argv[++i];
+    if (key == "--nodes")
+      o.nodes = std::atoi(value);
+    else if (key == "--cars")
+      o.cars = std::atoi(value);
+    else if (key == "--trucks")
+      o.trucks = std::atoi(value);
+    else if (key == "--seconds")
+      o.seconds = std::atof(value);
+    else if (key == "--dt")
+      o.dt = std::atof(value);
+    else if (key == "--threads")
+      o.threads = static_cast<unsigned>(std::atoi(value));
+    else if (key == "--seed")
+      o.seed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    else if (key == "--model") {
+      const std::string model = value;
+      if (model != "micro" && model != "meso")
+        return false;
+      o.mesoscopic = model == "meso";
+    } else
+      return false;
+  }
+  return o.nodes > 1 && o.cars >= 0 && o.trucks >= 0 && o.seconds > 0.0 &&
+         o.dt > 0.0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options opt;
+  if (!parse(argc, argv, opt)) {
+    usage(argv[0]);
+    return 2;
+  }
+  Parameters::set_targetNodes(opt.nodes);
+  Parameters::set_simulationThreads(opt.threads);
+  Parameters::set_mesoscopic(opt.mesoscopic);
+
+  using clock = std::chrono::steady_clock;
+  std::mt19937 rng{opt.seed};
+  RandomNetworkParams netp;
+  // Grow the map with the node count so every node fits at minDistPx.
+  const int side = static_cast<int>(
+      2.0 * netp.minDistPx * std::sqrt(static_cast<double>(opt.nodes)));
+  netp.maxX = std::max(netp.maxX, netp.minX + side);
+  netp.maxY = std::max(netp.maxY, netp.minY + side);
+  auto graph = SimulationUtils::makeRandomRoadNetwork(netp, rng);
+  auto nodeIds = SimulationUtils::collectNodeIds(graph);
+
+  Simulation sim(std::move(graph));
+  SimulationUtils::FleetManager fleet(sim, nodeIds, opt.cars, opt.trucks,
+                                      opt.seed);
+  const auto seedStart = clock::now();
+  fleet.seedInitial();
+  const double seedSeconds =
+      std::chrono::duration<double>(clock::now() - seedStart).count();
+  sim.setOnPostUpdate([&](double) { fleet.topUpIfNeeded(); });
+  sim.start();
+
+  const auto ticks = static_cast<std::uint64_t>(opt.seconds / opt.dt + 0.5);
+  const std::size_t spawnedBefore = sim.spawnCount();
+  std::uint64_t vehicleUpdates = 0;
+  const std::uint64_t allocsBefore = g_allocations.load();
+  const auto runStart = clock::now();
+  for (std::uint64_t t = 0; t < ticks; ++t) {
+    vehicleUpdates += sim.stats().vehicles;
+    sim.update(opt.dt);
+  }
+  const double wall =
+      std::chrono::duration<double>(clock::now() - runStart).count();
+  const double allocsPerTick =
+      ticks ? static_cast<double>(g_allocations.load() - allocsBefore) /
+                  static_cast<double>(ticks)
+            : 0.0;
+  // Initial routes of vehicles spawned during the run plus reroute searches.
+  const std::size_t routes = sim.spawnCount() - spawnedBefore +
+                             sim.rerouteScheduler().totalDispatched();
+
+  const double perSecond = wall > 0.0 ? 1.0 / wall : 0.0;
+  std::cout << std::fixed << std::setprecision(3)
+            << "network     " << sim.graph().getNodes().size() << " nodes, "
+            << sim.graph().getEdges().size() << " edges\n"
+            << "fleet       " << opt.cars << " cars, " << opt.trucks
+            << " trucks (seeded in " << seedSeconds << " s)\n"
+            << "model       " << (opt.mesoscopic ? "mesoscopic" : "microscopic")
+            << "\n"
+            << "threads     " << sim.scheduler().threads() << "\n"
+            << "simulated   " << sim.getSimTime() << " s in " << ticks
+            << " ticks, wall " << wall << " s\n"
+            << std::setprecision(1)
+            << "ticks/s     " << static_cast<double>(ticks) * perSecond << "\n"
+            << "veh-upd/s   " << static_cast<double>(vehicleUpdates) * perSecond
+            << "\n"
+            << "routes/s    " << static_cast<double>(routes) * perSecond << "\n"
+            << "reroutes    " << sim.rerouteCount() << " applied, "
+            << sim.reroutesInFlight() << " in flight\n"
+            << "allocs/tick " << allocsPerTick << " ("
+            << sim.stats().recycled << " vehicles recycled)\n";
+  return 0;
+}
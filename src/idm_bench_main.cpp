@@ -0,0 +1,182 @@
+/**
+ * @file idm_bench_main.cpp
+ * @brief Checks idm_accel_batch() against the scalar idm_accel() and
+ * measures both in vehicles per second.
+ *
+ * Usage: easy_rider_idm_bench [--vehicles N] [--reps N] [--delta D]
+ *        [--seed N]
+ *
+ * The comparison covers the integer exponents 1 to 4 and a fractional one
+ * (the std::pow fallback) over random inputs, including speeds and gaps
+ * below the kernel's floors. The program exits with status 1 if any result
+ * differs from idm_accel() by more than kTolerance, relative to
+ * max(|accel|, a). Configure with -DEASY_RIDER_AVX2=ON to measure the AVX2
+ * path; the "kernel" line says which one was built.
+ */
+#include "Easy_rider/Vehicles/IDMBatch.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A few ulp of the accelerations involved.
+constexpr double kTolerance = 1e-13;
+
+struct Options {
+  std::size_t vehicles = 4096;
+  int reps = 2000;
+  double delta = 4.0;
+  std::uint32_t seed = 1;
+};
+
+void usage(const char *argv0) {
+  std::cerr << "usage: " << argv0
+            << " [--vehicles N] [--reps N] [--delta D] [--seed N]\n";
+}
+
+bool parse(int argc, char **argv, Options &o) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (i + 1 >= argc)
+      return false;
+    const char *value = argv[++i];
+    if (key == "--vehicles")
+      o.vehicles = static_cast<std::size_t>(std::strtoul(value, nullptr, 10));
+    else if (key == "--reps")
+      o.reps = std::atoi(value);
+    else if (key == "--delta")
+      o.delta = std::atof(value);
+    else if (key == "--seed")
+      o.seed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    else
+      return false;
+  }
+  return o.vehicles > 0 && o.reps > 0 && o.delta > 0.0;
+}
+
+// Kernel inputs for n vehicles, in the ranges VehicleStore produces and a
+// little beyond (negative speeds, zero gaps and desired speeds).
+struct Inputs {
+  std::vector<double> v, v0, gap, dv;
+
+  Inputs(std::size_t n, std::mt19937 &rng) : v(n), v0(n), gap(n), dv(n) {
+    std::uniform_real_distribution<double> speed(-1.0, 40.0);
+    std::uniform_real_distribution<double> limit(0.0, 40.0);
+    std::uniform_real_distribution<double> dist(0.0, 200.0);
+    std::uniform_real_distribution<double> closing(-20.0, 20.0);
+    for (std::size_t i = 0; i < n; ++i) {
+      v[i] = speed(rng);
+      v0[i] = limit(rng);
+      gap[i] = dist(rng);
+      dv[i] = closing(rng);
+    }
+  }
+};
+
+// Largest |batch - idm_accel| / max(|idm_accel|, a) over @p in.
+double maxRelativeError(const IDMParams &p, const Inputs &in) {
+  const std::size_t n = in.v.size();
+  std::vector<double> out(n);
+  idm_accel_batch(p, n, in.v.data(), in.v0.data(), in.gap.data(),
+                  in.dv.data(), out.data());
+  double worst = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const double ref = idm_accel(in.v[i], in.v0[i], in.gap[i], in.dv[i], p);
+    const double err = std::abs(out[i] - ref) / std::max(std::abs(ref), p.a);
+    // A NaN on either side counts as a mismatch.
+    worst = std::max(
+        worst, std::isnan(err) ? std::numeric_limits<double>::infinity() : err);
+  }
+  return worst;
+}
+
+// Largest distance in ulp between ipow<4>(x) and std::pow(x, 4) over the
+// free-road ratios v / v0 of @p in.
+std::int64_t maxPowUlp(const Inputs &in) {
+  std::int64_t worst = 0;
+  for (std::size_t i = 0; i < in.v.size(); ++i) {
+    const double x = std::max(0.0, in.v[i]) / std::max(1e-3, in.v0[i]);
+    const auto a = std::bit_cast<std::int64_t>(idm_detail::ipow<4>(x));
+    const auto b = std::bit_cast<std::int64_t>(std::pow(x, 4.0));
+    worst = std::max(worst, a > b ? a - b : b - a);
+  }
+  return worst;
+}
+
+// Vehicles per second of @p run, which handles all of @p in once.
+template <class Run>
+double vehiclesPerSecond(const Options &o, const Inputs &in, Run run) {
+  using clock = std::chrono::steady_clock;
+  run(); // Warm up caches and branch predictors.
+  const auto start = clock::now();
+  for (int r = 0; r < o.reps; ++r)
+    run();
+  const double wall =
+      std::chrono::duration<double>(clock::now() - start).count();
+  return wall > 0.0 ? static_cast<double>(in.v.size()) * o.reps / wall : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options opt;
+  if (!parse(argc, argv, opt)) {
+    usage(argv[0]);
+    return 2;
+  }
+  std::mt19937 rng{opt.seed};
+  IDMParams p;
+
+  std::cout << "kernel      " << (idm_batch_uses_avx2() ? "avx2" : "scalar")
+            << "\n";
+
+  // Correctness: 1M vehicles per exponent.
+  bool ok = true;
+  const Inputs check(std::size_t{1} << 20, rng);
+  for (double delta : {1.0, 2.0, 3.0, 4.0, 4.5}) {
+    p.delta = delta;
+    const double err = maxRelativeError(p, check);
+    ok = ok && err <= kTolerance;
+    std::cout << "delta " << std::setw(3) << delta << "   max rel error "
+              << std::scientific << std::setprecision(2) << err
+              << std::defaultfloat << (err <= kTolerance ? "" : "  FAIL")
+              << "\n";
+  }
+  std::cout << "ipow<4>     max " << maxPowUlp(check)
+            << " ulp from std::pow\n";
+
+  // Throughput over a batch of the size VehicleStore hands the kernel.
+  p.delta = opt.delta;
+  const Inputs in(opt.vehicles, rng);
+  const std::size_t n = in.v.size();
+  std::vector<double> out(n);
+  volatile double sink = 0.0; // Keeps the loops from being optimised away.
+  const double scalar = vehiclesPerSecond(opt, in, [&] {
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] = idm_accel(in.v[i], in.v0[i], in.gap[i], in.dv[i], p);
+    sink = out[n - 1];
+  });
+  const double batched = vehiclesPerSecond(opt, in, [&] {
+    idm_accel_batch(p, n, in.v.data(), in.v0.data(), in.gap.data(),
+                    in.dv.data(), out.data());
+    sink = out[n - 1];
+  });
+
+  std::cout << std::fixed << std::setprecision(1) << "delta " << opt.delta
+            << ", " << n << " vehicles x " << opt.reps << " reps\n"
+            << "idm_accel   " << scalar / 1e6 << " M vehicles/s\n"
+            << "batch       " << batched / 1e6 << " M vehicles/s ("
+            << (scalar > 0.0 ? batched / scalar : 0.0) << "x)\n";
+  return ok ? 0 : 1;
+}